@@ -0,0 +1,215 @@
+#include <charconv>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bulk_loader.h"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot open "s + path);
+        }
+        struct stat file_stat;
+        if (fstat(fd_, &file_stat) != 0) {
+            close(fd_);
+            throw std::runtime_error("Cannot stat "s + path);
+        }
+        size_ = static_cast<size_t>(file_stat.st_size);
+        if (size_ > 0) {
+            data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (data_ == MAP_FAILED) {
+                close(fd_);
+                throw std::runtime_error("Cannot map "s + path);
+            }
+            madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+    }
+
+    ~MappedFile() {
+        if (size_ > 0) {
+            munmap(data_, size_);
+        }
+        close(fd_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view GetData() const {
+        return size_ > 0 ? std::string_view(static_cast<const char*>(data_), size_) : std::string_view();
+    }
+
+private:
+    int fd_ = -1;
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+struct ParsedDocument {
+    int id = 0;  // для PLAIN — номер строки внутри куска
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+    std::vector<std::string_view> words;
+};
+
+struct ParsedChunk {
+    std::vector<ParsedDocument> documents;
+    int line_count = 0;
+};
+
+std::vector<std::string_view> SplitIntoChunks(std::string_view corpus, size_t chunk_size) {
+    std::vector<std::string_view> chunks;
+    while (!corpus.empty()) {
+        size_t end = std::min(chunk_size, corpus.size());
+        if (end < corpus.size()) {
+            const size_t line_end = corpus.find('\n', end - 1);
+            end = line_end == corpus.npos ? corpus.size() : line_end + 1;
+        }
+        chunks.push_back(corpus.substr(0, end));
+        corpus.remove_prefix(end);
+    }
+    return chunks;
+}
+
+[[noreturn]] void ThrowMalformedLine(std::string_view corpus, std::string_view line) {
+    throw std::invalid_argument("Malformed corpus line at offset "s
+                                + std::to_string(line.data() - corpus.data()));
+}
+
+int ParseInt(std::string_view corpus, std::string_view line, std::string_view field) {
+    int value = 0;
+    const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (error != std::errc() || end != field.data() + field.size()) {
+        ThrowMalformedLine(corpus, line);
+    }
+    return value;
+}
+
+DocumentStatus ParseStatus(std::string_view corpus, std::string_view line, std::string_view field) {
+    if (field == "ACTUAL"sv || field == "0"sv) {
+        return DocumentStatus::ACTUAL;
+    }
+    if (field == "IRRELEVANT"sv || field == "1"sv) {
+        return DocumentStatus::IRRELEVANT;
+    }
+    if (field == "BANNED"sv || field == "2"sv) {
+        return DocumentStatus::BANNED;
+    }
+    if (field == "REMOVED"sv || field == "3"sv) {
+        return DocumentStatus::REMOVED;
+    }
+    ThrowMalformedLine(corpus, line);
+}
+
+std::string_view NextField(std::string_view& line) {
+    const size_t tab = line.find('\t');
+    const std::string_view field = line.substr(0, tab);
+    line.remove_prefix(tab == line.npos ? line.size() : tab + 1);
+    return field;
+}
+
+ParsedChunk ParseChunk(const SearchServer& search_server, std::string_view corpus,
+                       std::string_view chunk, const LoadOptions& options) {
+    ParsedChunk parsed;
+    while (!chunk.empty()) {
+        const size_t line_end = chunk.find('\n');
+        std::string_view line = chunk.substr(0, line_end);
+        chunk.remove_prefix(line_end == chunk.npos ? chunk.size() : line_end + 1);
+        const int line_index = parsed.line_count++;
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        ParsedDocument document;
+        if (options.format == CorpusFormat::PLAIN) {
+            document.id = line_index;
+            document.status = options.status;
+            document.words = search_server.TokenizeDocument(line);
+        } else {
+            std::string_view rest = line;
+            const std::string_view id = NextField(rest);
+            const std::string_view status = NextField(rest);
+            std::string_view ratings = NextField(rest);
+            if (id.data() + id.size() == line.data() + line.size()
+                || status.data() + status.size() == line.data() + line.size()) {
+                ThrowMalformedLine(corpus, line);
+            }
+            document.id = ParseInt(corpus, line, id);
+            document.status = ParseStatus(corpus, line, status);
+            for (const std::string_view rating : SplitIntoWords(ratings)) {
+                document.ratings.push_back(ParseInt(corpus, line, rating));
+            }
+            document.words = search_server.TokenizeDocument(rest);
+        }
+        parsed.documents.push_back(std::move(document));
+    }
+    return parsed;
+}
+
+}  // namespace
+
+double LoadStats::GetMegabytesPerSecond() const {
+    return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+std::ostream& operator<<(std::ostream& out, const LoadStats& stats) {
+    out << "loaded "s << stats.documents << " documents, "s << stats.bytes << " bytes in "s
+        << stats.chunks << " chunks, "s << stats.seconds << " s, "s
+        << stats.GetMegabytesPerSecond() << " MB/s"s;
+    return out;
+}
+
+LoadStats LoadCorpusFile(SearchServer& search_server, const std::string& path, const LoadOptions& options) {
+    const MappedFile file(path);
+    return LoadCorpus(search_server, file.GetData(), options);
+}
+
+LoadStats LoadCorpus(SearchServer& search_server, std::string_view corpus, const LoadOptions& options) {
+    const auto start_time = std::chrono::steady_clock::now();
+    const std::vector<std::string_view> chunks = SplitIntoChunks(corpus, std::max<size_t>(options.chunk_size, 1));
+    const size_t max_in_flight = 2 * std::max<size_t>(options.thread_count, 1);
+
+    LoadStats stats;
+    stats.bytes = corpus.size();
+    stats.chunks = chunks.size();
+
+    // токенизация только читает стоп-слова, поэтому идёт параллельно с добавлением
+    const SearchServer& tokenizer = search_server;
+    std::deque<std::future<ParsedChunk>> in_flight;
+    size_t next_chunk = 0;
+    int first_line_id = options.first_document_id;
+    while (next_chunk < chunks.size() || !in_flight.empty()) {
+        while (next_chunk < chunks.size() && in_flight.size() < max_in_flight) {
+            in_flight.push_back(std::async(std::launch::async, ParseChunk, std::cref(tokenizer),
+                                           corpus, chunks[next_chunk], std::cref(options)));
+            ++next_chunk;
+        }
+        ParsedChunk parsed = in_flight.front().get();
+        in_flight.pop_front();
+        for (ParsedDocument& document : parsed.documents) {
+            const int document_id = options.format == CorpusFormat::PLAIN ? first_line_id + document.id : document.id;
+            search_server.AddDocument(document_id, document.words, document.status, document.ratings);
+        }
+        stats.documents += parsed.documents.size();
+        first_line_id += parsed.line_count;
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return stats;
+}
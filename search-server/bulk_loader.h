@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "search_server.h"
+
+enum class CorpusFormat {
+    PLAIN,  // документ на строку, id = first_document_id + номер строки
+    TSV,    // id \t статус \t рейтинги через пробел \t текст
+};
+
+struct LoadOptions {
+    CorpusFormat format = CorpusFormat::PLAIN;
+    size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunk_size = 16 * 1024 * 1024;
+    // только для PLAIN
+    int first_document_id = 0;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+};
+
+struct LoadStats {
+    size_t bytes = 0;
+    size_t documents = 0;
+    size_t chunks = 0;
+    double seconds = 0.0;
+
+    double GetMegabytesPerSecond() const;
+};
+
+std::ostream& operator<<(std::ostream& out, const LoadStats& stats);
+
+// Файл отображается в память целиком и делится на куски по границам строк.
+// Куски разбираются и токенизируются параллельно (не больше 2 * thread_count
+// одновременно), а в индекс добавляются по порядку в вызывающем потоке.
+// Текст документов не копируется: в индекс попадают только слова словаря.
+// Бросает std::runtime_error при ошибке чтения файла и std::invalid_argument
+// на некорректной строке.
+LoadStats LoadCorpusFile(SearchServer& search_server, const std::string& path, const LoadOptions& options = {});
+
+// То же для данных, уже находящихся в памяти.
+LoadStats LoadCorpus(SearchServer& search_server, std::string_view corpus, const LoadOptions& options = {});
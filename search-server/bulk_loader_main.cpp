@@ -0,0 +1,92 @@
+#include "bulk_loader.h"
+#include "query_generator.h"
+
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+ 
+using namespace std;
+ 
+namespace {
+ 
+void PrintUsage() {
+    cerr << "Usage: bulk_loader [--format plain|tsv] [--threads N] [--chunk-mb N]\n"
+            "                   [--stop-words \"WORDS\"] [--generate-documents N]\n"
+            "                   [--dictionary-size N] [--seed N] FILE\n"
+            "With --generate-documents the corpus is written to FILE first.\n"s;
+}
+ 
+void WriteCorpus(const string& path, CorpusFormat format, int document_count, int dictionary_size, unsigned seed) {
+    mt19937 generator(seed);
+    const auto dictionary = GenerateDictionary(generator, dictionary_size, 10);
+    ofstream out(path, ios::binary);
+    for (int id = 0; id < document_count; ++id) {
+        if (format == CorpusFormat::TSV) {
+            out << id << "\tACTUAL\t"s << id % 10 << ' ' << id % 7 << '\t';
+        }
+        out << GenerateQuery(generator, dictionary, 70) << '\n';
+    }
+    if (!out) {
+        throw runtime_error("Cannot write "s + path);
+    }
+}
+ 
+}  // namespace
+ 
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    string path;
+    string stop_words;
+    int document_count = 0;
+    int dictionary_size = 1000;
+    unsigned seed = mt19937::default_seed;
+ 
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (arg.rfind("--"s, 0) != 0) {
+            path = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+        const string value = argv[++i];
+        if (arg == "--format"s && (value == "plain"s || value == "tsv"s)) {
+            options.format = value == "tsv"s ? CorpusFormat::TSV : CorpusFormat::PLAIN;
+        } else if (arg == "--threads"s) {
+            options.thread_count = stoul(value);
+        } else if (arg == "--chunk-mb"s) {
+            options.chunk_size = stoul(value) * 1024 * 1024;
+        } else if (arg == "--stop-words"s) {
+            stop_words = value;
+        } else if (arg == "--generate-documents"s) {
+            document_count = stoi(value);
+        } else if (arg == "--dictionary-size"s) {
+            dictionary_size = stoi(value);
+        } else if (arg == "--seed"s) {
+            seed = stoul(value);
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (path.empty()) {
+        PrintUsage();
+        return 1;
+    }
+ 
+    try {
+        if (document_count > 0) {
+            WriteCorpus(path, options.format, document_count, dictionary_size, seed);
+        }
+        SearchServer search_server(stop_words);
+        cout << LoadCorpusFile(search_server, path, options) << endl;
+        cout << search_server.GetMemoryStats() << endl;
+    } catch (const exception& e) {
+        cerr << "bulk_loader: "s << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bulk_loader.h"
+#include "search_server.h"
+#include "test_framework.h"
+
+using namespace std;
+
+namespace {
+
+const string STOP_WORDS = "и в на"s;
+
+vector<int> GetDocumentIds(const SearchServer& search_server) {
+    return vector<int>(search_server.begin(), search_server.end());
+}
+
+// Документы двух серверов совпадают вплоть до частот слов.
+void AssertSameIndex(const SearchServer& actual, const SearchServer& expected, const string& hint) {
+    ASSERT_HINT(GetDocumentIds(actual) == GetDocumentIds(expected), hint);
+    for (const int document_id : expected) {
+        ASSERT_HINT(actual.GetWordFrequencies(document_id) == expected.GetWordFrequencies(document_id),
+                    hint + " "s + to_string(document_id));
+    }
+}
+
+string MakeCorpus(int line_count) {
+    const vector<string> dictionary = {"кот"s, "пёс"s, "хвост"s, "ошейник"s, "и"s, "скворец"s, "в"s};
+    mt19937 generator(5);
+    string corpus;
+    for (int line = 0; line < line_count; ++line) {
+        const int word_count = uniform_int_distribution<int>(0, 6)(generator);
+        for (int i = 0; i < word_count; ++i) {
+            corpus += (i > 0 ? " "s : ""s) + dictionary[uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)];
+        }
+        corpus += line % 5 == 0 ? "\r\n"s : "\n"s;
+    }
+    return corpus;
+}
+
+}  // namespace
+
+// id — номер строки, пустые строки тоже занимают номер.
+void TestPlainIdsFollowLines() {
+    SearchServer search_server(STOP_WORDS);
+    LoadOptions options;
+    options.first_document_id = 10;
+    options.status = DocumentStatus::BANNED;
+    const LoadStats stats = LoadCorpus(search_server, "кот\n\nпёс и хвост\r\nи\nошейник"sv, options);
+
+    ASSERT_EQUAL(stats.documents, 4u);
+    ASSERT(GetDocumentIds(search_server) == vector<int>({10, 12, 13, 14}));
+    const auto found = search_server.FindTopDocuments("хвост"s, DocumentStatus::BANNED);
+    ASSERT_EQUAL(found.size(), 1u);
+    ASSERT_EQUAL(found[0].id, 12);
+    // \r не попадает в слово, стоп-слова не индексируются
+    ASSERT_EQUAL(search_server.GetWordFrequencies(12).size(), 2u);
+    ASSERT(search_server.GetWordFrequencies(13).empty());
+    ASSERT_EQUAL(search_server.FindTopDocuments("ошейник"s, DocumentStatus::BANNED).at(0).id, 14);
+}
+
+// Куски режутся по границам строк: результат не зависит от размера куска и числа потоков.
+void TestChunkBoundaries() {
+    const string corpus = MakeCorpus(300);
+    SearchServer expected(STOP_WORDS);
+    int line_id = 0;
+    for (string_view rest = corpus; !rest.empty(); ++line_id) {
+        const size_t line_end = rest.find('\n');
+        string_view line = rest.substr(0, line_end);
+        rest.remove_prefix(line_end + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+            expected.AddDocument(line_id, line, DocumentStatus::ACTUAL, {});
+        }
+    }
+    ASSERT_EQUAL(line_id, 300);
+
+    for (const size_t chunk_size : {size_t{1}, size_t{7}, size_t{64}, size_t{1} << 20}) {
+        for (const size_t thread_count : {size_t{1}, size_t{4}}) {
+            SearchServer search_server(STOP_WORDS);
+            LoadOptions options;
+            options.chunk_size = chunk_size;
+            options.thread_count = thread_count;
+            const LoadStats stats = LoadCorpus(search_server, corpus, options);
+            const string hint = "chunk "s + to_string(chunk_size) + ", threads "s + to_string(thread_count);
+            ASSERT_EQUAL_HINT(stats.bytes, corpus.size(), hint);
+            ASSERT_EQUAL_HINT(stats.documents, static_cast<size_t>(expected.GetDocumentCount()), hint);
+            if (chunk_size == 1) {
+                ASSERT_EQUAL_HINT(stats.chunks, 300u, hint);
+            }
+            AssertSameIndex(search_server, expected, hint);
+        }
+    }
+}
+
+void TestTsvFields() {
+    SearchServer search_server(STOP_WORDS);
+    LoadOptions options;
+    options.format = CorpusFormat::TSV;
+    options.chunk_size = 5;
+    LoadCorpus(search_server,
+               "5\tBANNED\t1 2 3\tкот и пёс\n"
+               "7\t0\t\tхвост\r\n"
+               "\n"
+               "9\tIRRELEVANT\t-4 10\tкот\n"
+               "3\t3\t8\tкот\n"sv,
+               options);
+
+    ASSERT(GetDocumentIds(search_server) == vector<int>({3, 5, 7, 9}));
+    const auto banned = search_server.FindTopDocuments("кот"s, DocumentStatus::BANNED);
+    ASSERT_EQUAL(banned.size(), 1u);
+    ASSERT_EQUAL(banned[0].id, 5);
+    ASSERT_EQUAL(banned[0].rating, 2);
+    const auto actual = search_server.FindTopDocuments("хвост"s);
+    ASSERT_EQUAL(actual.size(), 1u);
+    ASSERT_EQUAL(actual[0].rating, 0);
+    ASSERT_EQUAL(search_server.FindTopDocuments("кот"s, DocumentStatus::IRRELEVANT).at(0).rating, 3);
+    ASSERT_EQUAL(search_server.FindTopDocuments("кот"s, DocumentStatus::REMOVED).at(0).rating, 8);
+    ASSERT_EQUAL(search_server.GetWordFrequencies(5).size(), 2u);
+}
+
+void TestMalformedLines() {
+    LoadOptions tsv;
+    tsv.format = CorpusFormat::TSV;
+    const vector<string_view> malformed = {
+        "x\tACTUAL\t1\tкот"sv,
+        "1\tUNKNOWN\t1\tкот"sv,
+        "1\tACTUAL\t1 x\tкот"sv,
+        "1\tACTUAL\t99999999999\tкот"sv,
+        "1\tACTUAL"sv,
+        "1"sv,
+        "-1\tACTUAL\t1\tкот"sv,
+        "1\tACTUAL\t1\tкот\n1\tACTUAL\t1\tпёс"sv,
+        "1\tACTUAL\t1\tкот\tпёс"sv,
+    };
+    for (const string_view corpus : malformed) {
+        SearchServer search_server(STOP_WORDS);
+        ASSERT_THROWS(LoadCorpus(search_server, corpus, tsv), invalid_argument);
+    }
+
+    SearchServer search_server(STOP_WORDS);
+    ASSERT_THROWS(LoadCorpus(search_server, "кот\nпёс\x01\n"sv), invalid_argument);
+}
+
+void TestLoadCorpusFile() {
+    const string corpus = MakeCorpus(50);
+    const string path = "/tmp/bulk_loader_test_"s + to_string(getpid()) + ".txt"s;
+    {
+        ofstream out(path, ios::binary);
+        out << corpus;
+    }
+    SearchServer from_file(STOP_WORDS);
+    SearchServer from_memory(STOP_WORDS);
+    const LoadStats stats = LoadCorpusFile(from_file, path);
+    LoadCorpus(from_memory, corpus);
+    remove(path.c_str());
+
+    ASSERT_EQUAL(stats.bytes, corpus.size());
+    AssertSameIndex(from_file, from_memory, path);
+
+    const string empty_path = path + ".empty"s;
+    ofstream(empty_path).close();
+    SearchServer empty(STOP_WORDS);
+    ASSERT_EQUAL(LoadCorpusFile(empty, empty_path).documents, 0u);
+    remove(empty_path.c_str());
+
+    ASSERT_THROWS(LoadCorpusFile(empty, path), runtime_error);
+}
+
+// Публичная перегрузка со списком слов проверяет их так же, как текст документа.
+void TestAddDocumentWords() {
+    SearchServer search_server(STOP_WORDS);
+    search_server.AddDocument(1, vector<string_view>{"кот"sv, "и"sv, "кот"sv}, DocumentStatus::ACTUAL, {1});
+    const auto frequencies = search_server.GetWordFrequencies(1);
+    ASSERT_EQUAL(frequencies.size(), 1u);
+    ASSERT_EQUAL(frequencies.at("кот"sv), 1.0);
+
+    for (const string_view word : {""sv, "кот пёс"sv, "пёс\x02"sv, "\t"sv}) {
+        ASSERT_THROWS(search_server.AddDocument(2, vector<string_view>{"хвост"sv, word}, DocumentStatus::ACTUAL, {}),
+                      invalid_argument);
+    }
+    ASSERT_EQUAL(search_server.GetDocumentCount(), 1);
+    ASSERT(search_server.FindTopDocuments("хвост"s).empty());
+}
+
+int main() {
+    RUN_TEST(TestPlainIdsFollowLines);
+    RUN_TEST(TestChunkBoundaries);
+    RUN_TEST(TestTsvFields);
+    RUN_TEST(TestMalformedLines);
+    RUN_TEST(TestLoadCorpusFile);
+    RUN_TEST(TestAddDocumentWords);
+}
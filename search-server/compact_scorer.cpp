@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "compact_scorer.h"
+
+namespace {
+
+constexpr float FIXED16_SCALE = 65535.0f;
+
+void ScaleTermFrequencies(const float* term_freqs, size_t count, float factor, float* out) {
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256 factors = _mm256_set1_ps(factor);
+    for (; i + 8 <= count; i += 8) {
+        const __m256 values = _mm256_loadu_ps(term_freqs + i);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(values, factors));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = term_freqs[i] * factor;
+    }
+}
+
+void ScaleFixedTermFrequencies(const uint16_t* term_freqs, size_t count, float factor, float* out) {
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256 factors = _mm256_set1_ps(factor);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(term_freqs + i));
+        const __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(packed));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(values, factors));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = term_freqs[i] * factor;
+    }
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& out, const RankingAgreement& agreement) {
+    out << "{ queries = "s << agreement.query_count
+        << ", identical_rankings = "s << agreement.identical_rankings
+        << ", consistent_rankings = "s << agreement.consistent_rankings
+        << ", identical_sets = "s << agreement.identical_sets
+        << ", max_relevance_error = "s << agreement.max_relevance_error << " }"s;
+    return out;
+}
+
+CompactScorer::CompactScorer(const SearchServer& search_server, ScorePrecision precision)
+    : search_server_(search_server)
+    , precision_(precision) {
+    std::map<int, uint32_t> document_id_to_slot;
+    for (const auto& [document_id, document_data] : search_server_.documents_) {
+        document_id_to_slot[document_id] = static_cast<uint32_t>(slot_to_document_id_.size());
+        slot_to_document_id_.push_back(document_id);
+        slot_to_status_.push_back(document_data.status);
+        slot_to_rating_.push_back(document_data.rating);
+    }
+
+    for (const auto& [word, document_freqs] : search_server_.word_to_document_freqs_) {
+        if (document_freqs.empty()) {
+            continue;
+        }
+        std::string_view word_view = word;
+        // ключи снимка — копии: слова сервера удаляются вместе с последним документом
+        PostingList& list = word_to_postings_.emplace_hint(word_to_postings_.end(), word, PostingList{})->second;
+        list.inverse_document_freq = static_cast<float>(search_server_.ComputeWordInverseDocumentFreq(word_view));
+        list.slots.reserve(document_freqs.size());
+        if (precision_ == ScorePrecision::FLOAT) {
+            list.term_freqs.reserve(document_freqs.size());
+        } else {
+            list.fixed_term_freqs.reserve(document_freqs.size());
+            for (const auto& [_, term_freq] : document_freqs) {
+                list.max_term_freq = std::max(list.max_term_freq, static_cast<float>(term_freq));
+            }
+        }
+        for (const auto& [document_id, term_freq] : document_freqs) {
+            list.slots.push_back(document_id_to_slot.at(document_id));
+            if (precision_ == ScorePrecision::FLOAT) {
+                list.term_freqs.push_back(static_cast<float>(term_freq));
+            } else {
+                list.fixed_term_freqs.push_back(static_cast<uint16_t>(
+                    std::lround(term_freq / list.max_term_freq * FIXED16_SCALE)));
+            }
+        }
+    }
+}
+
+CompactScorer::ScratchLease::ScratchLease(size_t slot_count) {
+    auto& pool = GetScratchPool();
+    if (pool.empty()) {
+        scratch_ = std::make_unique<Scratch>();
+    } else {
+        scratch_ = std::move(pool.back());
+        pool.pop_back();
+    }
+    if (scratch_->scores.size() < slot_count) {
+        scratch_->scores.resize(slot_count, 0.0f);
+        scratch_->states.resize(slot_count, UNTOUCHED);
+    }
+}
+
+CompactScorer::ScratchLease::~ScratchLease() {
+    for (const uint32_t slot : scratch_->touched_slots) {
+        scratch_->scores[slot] = 0.0f;
+        scratch_->states[slot] = UNTOUCHED;
+    }
+    scratch_->touched_slots.clear();
+    try {
+        GetScratchPool().push_back(std::move(scratch_));
+    } catch (const std::bad_alloc&) {
+        // буферы просто освобождаются
+    }
+}
+
+// Буферы живут, пока жив поток, и растут до самого большого снимка, с которым он работал.
+std::vector<std::unique_ptr<CompactScorer::Scratch>>& CompactScorer::GetScratchPool() {
+    thread_local std::vector<std::unique_ptr<Scratch>> pool;
+    return pool;
+}
+
+std::vector<Document> CompactScorer::FindTopDocuments(std::string_view raw_query, DocumentStatus status) const {
+    return FindTopDocuments(raw_query, [status](int, DocumentStatus document_status, int) {
+        return document_status == status;
+    });
+}
+
+std::vector<Document> CompactScorer::FindTopDocuments(std::string_view raw_query) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+ScorePrecision CompactScorer::GetPrecision() const {
+    return precision_;
+}
+
+size_t CompactScorer::GetPostingBytes() const {
+    size_t bytes = 0;
+    for (const auto& [_, list] : word_to_postings_) {
+        bytes += list.slots.size() * sizeof(uint32_t)
+               + list.term_freqs.size() * sizeof(float)
+               + list.fixed_term_freqs.size() * sizeof(uint16_t);
+    }
+    return bytes;
+}
+
+void CompactScorer::ScoreBlock(const PostingList& postings, size_t first, size_t count, float* out) const {
+    if (precision_ == ScorePrecision::FLOAT) {
+        ScaleTermFrequencies(postings.term_freqs.data() + first, count,
+                             postings.inverse_document_freq, out);
+    } else {
+        ScaleFixedTermFrequencies(postings.fixed_term_freqs.data() + first, count,
+                                  postings.inverse_document_freq * postings.max_term_freq / FIXED16_SCALE, out);
+    }
+}
+
+std::vector<Document> CompactScorer::SelectTopDocuments(const std::vector<float>& scores,
+                                                        const std::vector<uint32_t>& matched_slots) const {
+    std::vector<Document> matched_documents;
+    matched_documents.reserve(matched_slots.size());
+    for (const uint32_t slot : matched_slots) {
+        matched_documents.push_back({slot_to_document_id_[slot],
+                                     static_cast<double>(scores[slot]),
+                                     slot_to_rating_[slot]});
+    }
+
+    std::sort(matched_documents.begin(), matched_documents.end(), SearchServer::IsMoreRelevant);
+
+    if (matched_documents.size() > SearchServer::MAX_RESULT_DOCUMENT_COUNT) {
+        matched_documents.resize(SearchServer::MAX_RESULT_DOCUMENT_COUNT);
+    }
+    return matched_documents;
+}
+
+RankingAgreement CompactScorer::CompareWithDoublePrecision(const std::vector<std::string>& queries) const {
+    RankingAgreement agreement;
+    for (const std::string& query : queries) {
+        const auto expected = search_server_.FindTopDocuments(query);
+        const auto actual = FindTopDocuments(query);
+        ++agreement.query_count;
+
+        std::map<int, Document> expected_by_id;
+        for (const Document& document : expected) {
+            expected_by_id[document.id] = document;
+        }
+
+        const bool same_order = expected.size() == actual.size()
+            && std::equal(expected.begin(), expected.end(), actual.begin(),
+                          [](const Document& lhs, const Document& rhs) { return lhs.id == rhs.id; });
+        const bool same_set = expected.size() == actual.size()
+            && std::all_of(actual.begin(), actual.end(),
+                           [&expected_by_id](const Document& document) {
+                               return expected_by_id.count(document.id) > 0;
+                           });
+        if (same_order) {
+            ++agreement.identical_rankings;
+        }
+        if (!same_set) {
+            continue;
+        }
+        ++agreement.identical_sets;
+
+        bool consistent = true;
+        for (size_t i = 0; i < actual.size(); ++i) {
+            const Document& exact = expected_by_id.at(actual[i].id);
+            agreement.max_relevance_error = std::max(agreement.max_relevance_error,
+                                                     std::abs(exact.relevance - actual[i].relevance));
+            if (i == 0) {
+                continue;
+            }
+            // при равных с точностью до EPSILON релевантности и рейтинге допустим любой порядок id
+            const Document& previous = expected_by_id.at(actual[i - 1].id);
+            const bool tied = std::abs(exact.relevance - previous.relevance) < SearchServer::EPSILON
+                && exact.rating == previous.rating;
+            if (!tied && SearchServer::IsMoreRelevant(exact, previous)) {
+                consistent = false;
+            }
+        }
+        if (consistent) {
+            ++agreement.consistent_rankings;
+        }
+    }
+    return agreement;
+}
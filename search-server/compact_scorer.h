@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "search_server.h"
+
+enum class ScorePrecision {
+    FLOAT,
+    FIXED16,
+};
+
+struct RankingAgreement {
+    int query_count = 0;
+    int identical_rankings = 0;   // те же id в том же порядке
+    int consistent_rankings = 0;  // те же id, порядок допустим с учётом EPSILON
+    int identical_sets = 0;       // те же id в любом порядке
+    double max_relevance_error = 0.0;
+};
+
+std::ostream& operator<<(std::ostream& out, const RankingAgreement& agreement);
+
+// Снимок индекса SearchServer с tf в float или 16-битной фиксированной точке
+// и накоплением релевантности в плотных массивах float.
+// Снимок хранит свои копии слов и не видит последующих AddDocument/RemoveDocument:
+// чтобы учесть их, его нужно построить заново. Сам SearchServer должен пережить
+// снимок — запросы разбираются его ParseQuery.
+class CompactScorer {
+public:
+    CompactScorer(const SearchServer& search_server, ScorePrecision precision);
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+                                           DocumentPredicate document_predicate) const;
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status) const;
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    ScorePrecision GetPrecision() const;
+    size_t GetPostingBytes() const;
+
+    RankingAgreement CompareWithDoublePrecision(const std::vector<std::string>& queries) const;
+
+private:
+    struct PostingList {
+        float inverse_document_freq = 0.0f;
+        // tf в FIXED16 хранится в долях максимального tf списка,
+        // чтобы 16 бит покрывали реальный диапазон, а не весь [0, 1]
+        float max_term_freq = 0.0f;
+        std::vector<uint32_t> slots;
+        std::vector<float> term_freqs;
+        std::vector<uint16_t> fixed_term_freqs;
+    };
+
+    enum SlotState : uint8_t {
+        UNTOUCHED,
+        MATCHED,
+        REJECTED,
+        EXCLUDED,
+    };
+
+    // Плотные буферы запроса. Между запросами scores нулевые, а states — UNTOUCHED:
+    // после запроса сбрасываются только слоты из touched_slots, а не весь корпус.
+    struct Scratch {
+        std::vector<float> scores;
+        std::vector<uint8_t> states;
+        std::vector<uint32_t> touched_slots;
+    };
+
+    // Берёт буферы из пула текущего потока и возвращает их туда, сбросив
+    // затронутые слоты. Вложенный запрос (из предиката) получит свои буферы.
+    class ScratchLease {
+    public:
+        explicit ScratchLease(size_t slot_count);
+        ~ScratchLease();
+
+        ScratchLease(const ScratchLease&) = delete;
+        ScratchLease& operator=(const ScratchLease&) = delete;
+
+        Scratch& Get() {
+            return *scratch_;
+        }
+
+    private:
+        std::unique_ptr<Scratch> scratch_;
+    };
+
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    const SearchServer& search_server_;
+    const ScorePrecision precision_;
+    std::vector<int> slot_to_document_id_;
+    std::vector<DocumentStatus> slot_to_status_;
+    std::vector<int> slot_to_rating_;
+    std::map<std::string, PostingList, std::less<>> word_to_postings_;
+
+    static std::vector<std::unique_ptr<Scratch>>& GetScratchPool();
+
+    void ScoreBlock(const PostingList& postings, size_t first, size_t count, float* out) const;
+    std::vector<Document> SelectTopDocuments(const std::vector<float>& scores,
+                                             const std::vector<uint32_t>& matched_slots) const;
+};
+
+template <typename DocumentPredicate>
+std::vector<Document> CompactScorer::FindTopDocuments(std::string_view raw_query,
+                                                      DocumentPredicate document_predicate) const {
+    const auto query = search_server_.ParseQuery(raw_query, true);
+
+    ScratchLease lease(slot_to_document_id_.size());
+    std::vector<float>& scores = lease.Get().scores;
+    std::vector<uint8_t>& states = lease.Get().states;
+    std::vector<uint32_t>& touched_slots = lease.Get().touched_slots;
+    std::vector<uint32_t> matched_slots;
+
+    for (std::string_view word : query.minus_words) {
+        const auto postings = word_to_postings_.find(word);
+        if (postings == word_to_postings_.end()) {
+            continue;
+        }
+        for (const uint32_t slot : postings->second.slots) {
+            if (states[slot] == UNTOUCHED) {
+                states[slot] = EXCLUDED;
+                touched_slots.push_back(slot);
+            }
+        }
+    }
+
+    float contributions[BLOCK_SIZE];
+    for (std::string_view word : query.plus_words) {
+        const auto postings = word_to_postings_.find(word);
+        if (postings == word_to_postings_.end()) {
+            continue;
+        }
+        const PostingList& list = postings->second;
+        for (size_t first = 0; first < list.slots.size(); first += BLOCK_SIZE) {
+            const size_t count = std::min(BLOCK_SIZE, list.slots.size() - first);
+            ScoreBlock(list, first, count, contributions);
+            for (size_t i = 0; i < count; ++i) {
+                const uint32_t slot = list.slots[first + i];
+                if (states[slot] == UNTOUCHED) {
+                    touched_slots.push_back(slot);
+                    if (document_predicate(slot_to_document_id_[slot],
+                                           slot_to_status_[slot],
+                                           slot_to_rating_[slot])) {
+                        states[slot] = MATCHED;
+                        matched_slots.push_back(slot);
+                    } else {
+                        states[slot] = REJECTED;
+                    }
+                }
+                if (states[slot] == MATCHED) {
+                    scores[slot] += contributions[i];
+                }
+            }
+        }
+    }
+
+    return SelectTopDocuments(scores, matched_slots);
+}
@@ -10,7 +10,6 @@
 #include <mutex>
  
 #include "log_duration.h"
-#include "test_framework.h"
  
 template <typename Key, typename Value>
 class ConcurrentMap {
@@ -1,5 +1,7 @@
 #pragma once
 #include <iostream>
+#include <map>
+#include <string>
 
 struct Document {
     Document() = default;
@@ -20,4 +22,11 @@ enum class DocumentStatus {
     REMOVED,
 };
 
+// Число документов и документные частоты слов запроса по всему корпусу.
+// Позволяет шарду считать IDF так же, как единый индекс.
+struct CorpusStatistics {
+    int document_count = 0;
+    std::map<std::string, int, std::less<>> document_freqs;
+};
+
 std::ostream& operator<<(std::ostream& out, const Document& document);
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "search_client.h"
+#include "query_generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+ 
+using namespace std;
+using Clock = chrono::steady_clock;
+ 
+namespace {
+ 
+struct ConnectionResult {
+    vector<int64_t> latencies_ns;
+    int errors = 0;
+};
+ 
+void PrintUsage() {
+    cerr << "Usage: load_generator [--endpoint HOST:PORT|unix:PATH] [--connections N]\n"
+            "                      [--pipeline N] [--queries N] [--query-words N]\n"
+            "                      [--dictionary-size N] [--seed N]\n"s;
+}
+ 
+ConnectionResult RunConnection(const string& endpoint, const vector<string>& queries,
+                               size_t first, size_t step, size_t pipeline_depth) {
+    SearchClient client(endpoint);
+    ConnectionResult result;
+    vector<Clock::time_point> sent_at(queries.size());
+ 
+    size_t next = first;
+    size_t in_flight = 0;
+    while (next < queries.size() || in_flight > 0) {
+        while (in_flight < pipeline_depth && next < queries.size()) {
+            Request request;
+            request.request_id = static_cast<uint32_t>(next);
+            request.type = RequestType::FIND_TOP_DOCUMENTS;
+            request.text = queries[next];
+            sent_at[next] = Clock::now();
+            client.Send(request);
+            ++in_flight;
+            next += step;
+        }
+        const Response response = client.Receive();
+        const auto latency = Clock::now() - sent_at.at(response.request_id);
+        result.latencies_ns.push_back(chrono::duration_cast<chrono::nanoseconds>(latency).count());
+        if (response.status != ResponseStatus::OK) {
+            ++result.errors;
+        }
+        --in_flight;
+    }
+    return result;
+}
+ 
+double PercentileMicros(const vector<int64_t>& sorted_latencies, double percentile) {
+    if (sorted_latencies.empty()) {
+        return 0.0;
+    }
+    const size_t index = min(sorted_latencies.size() - 1,
+                             static_cast<size_t>(percentile * sorted_latencies.size()));
+    return sorted_latencies[index] / 1000.0;
+}
+ 
+}  // namespace
+ 
+int main(int argc, char* argv[]) {
+    string endpoint = "127.0.0.1:7777"s;
+    size_t connection_count = 4;
+    size_t pipeline_depth = 16;
+    int query_count = 10'000;
+    int query_words = 10;
+    int dictionary_size = 1000;
+    unsigned seed = mt19937::default_seed;
+ 
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+        const string value = argv[++i];
+        if (arg == "--endpoint"s) {
+            endpoint = value;
+        } else if (arg == "--connections"s) {
+            connection_count = max<size_t>(1, stoul(value));
+        } else if (arg == "--pipeline"s) {
+            pipeline_depth = max<size_t>(1, stoul(value));
+        } else if (arg == "--queries"s) {
+            query_count = stoi(value);
+        } else if (arg == "--query-words"s) {
+            query_words = stoi(value);
+        } else if (arg == "--dictionary-size"s) {
+            dictionary_size = stoi(value);
+        } else if (arg == "--seed"s) {
+            seed = stoul(value);
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+ 
+    // тот же seed и размер словаря, что у search_daemon --generate-documents
+    mt19937 generator(seed);
+    const auto dictionary = GenerateDictionary(generator, dictionary_size, 10);
+    const auto queries = GenerateQueries(generator, dictionary, query_count, query_words);
+ 
+    vector<ConnectionResult> results(connection_count);
+    atomic<bool> failed = false;
+    const auto start = Clock::now();
+    {
+        vector<thread> threads;
+        for (size_t i = 0; i < connection_count; ++i) {
+            threads.emplace_back([&, i] {
+                try {
+                    results[i] = RunConnection(endpoint, queries, i, connection_count, pipeline_depth);
+                } catch (const exception& e) {
+                    cerr << "load_generator: "s << e.what() << endl;
+                    failed = true;
+                }
+            });
+        }
+        for (thread& t : threads) {
+            t.join();
+        }
+    }
+    const double elapsed_s = chrono::duration<double>(Clock::now() - start).count();
+    if (failed) {
+        return 1;
+    }
+ 
+    vector<int64_t> latencies;
+    int errors = 0;
+    for (const auto& result : results) {
+        latencies.insert(latencies.end(), result.latencies_ns.begin(), result.latencies_ns.end());
+        errors += result.errors;
+    }
+    sort(latencies.begin(), latencies.end());
+ 
+    cout << "requests: "s << latencies.size() << ", errors: "s << errors
+         << ", elapsed: "s << elapsed_s << " s, qps: "s << latencies.size() / elapsed_s << endl;
+    cout << "latency us: p50 = "s << PercentileMicros(latencies, 0.50)
+         << ", p90 = "s << PercentileMicros(latencies, 0.90)
+         << ", p99 = "s << PercentileMicros(latencies, 0.99)
+         << ", p999 = "s << PercentileMicros(latencies, 0.999)
+         << ", max = "s << (latencies.empty() ? 0.0 : latencies.back() / 1000.0) << endl;
+    return 0;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <chrono>
 #include <iostream>
+#include <string>
+#include <string_view>
  
 #define PROFILE_CONCAT_INTERNAL(X, Y) X##Y
 #define PROFILE_CONCAT(X, Y) PROFILE_CONCAT_INTERNAL(X, Y)
@@ -11,7 +13,7 @@
 class LogDuration {
 public:
     using Clock = std::chrono::steady_clock;
-    LogDuration(const std::string& id, std::ostream& out = std::cerr) : id_(id), out_(out) {}
+    LogDuration(std::string_view id, std::ostream& out = std::cerr) : id_(id), out_(out) {}
     ~LogDuration() {
         using namespace std::chrono;
         using namespace std::literals;
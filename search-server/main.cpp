@@ -1,6 +1,10 @@
 #include "search_server.h"
 #include "log_duration.h"
 #include "process_queries.h"
+#include "compact_scorer.h"
+#include "query_generator.h"
+#include "paginator.h"
+#include "request_queue.h"
 
 #include <execution>
 #include <iostream>
@@ -10,49 +14,6 @@
  
 using namespace std;
  
-string GenerateWord(mt19937& generator, int max_length) {
-    const int length = uniform_int_distribution(1, max_length)(generator);
-    string word;
-    word.reserve(length);
-    for (int i = 0; i < length; ++i) {
-        word.push_back(uniform_int_distribution('a', 'z')(generator));
-    }
-    return word;
-}
- 
-vector<string> GenerateDictionary(mt19937& generator, int word_count, int max_length) {
-    vector<string> words;
-    words.reserve(word_count);
-    for (int i = 0; i < word_count; ++i) {
-        words.push_back(GenerateWord(generator, max_length));
-    }
-    words.erase(unique(words.begin(), words.end()), words.end());
-    return words;
-}
- 
-string GenerateQuery(mt19937& generator, const vector<string>& dictionary, int word_count, double minus_prob = 0) {
-    string query;
-    for (int i = 0; i < word_count; ++i) {
-        if (!query.empty()) {
-            query.push_back(' ');
-        }
-        if (uniform_real_distribution<>(0, 1)(generator) < minus_prob) {
-            query.push_back('-');
-        }
-        query += dictionary[uniform_int_distribution<int>(0, dictionary.size() - 1)(generator)];
-    }
-    return query;
-}
- 
-vector<string> GenerateQueries(mt19937& generator, const vector<string>& dictionary, int query_count, int max_word_count) {
-    vector<string> queries;
-    queries.reserve(query_count);
-    for (int i = 0; i < query_count; ++i) {
-        queries.push_back(GenerateQuery(generator, dictionary, max_word_count));
-    }
-    return queries;
-}
- 
 template <typename ExecutionPolicy>
 void Test(string_view mark, const SearchServer& search_server, const vector<string>& queries, ExecutionPolicy&& policy) {
     LOG_DURATION(mark);
@@ -67,6 +28,22 @@ void Test(string_view mark, const SearchServer& search_server, const vector<stri
  
 #define TEST(policy) Test(#policy, search_server, queries, execution::policy)
  
+void TestCompactScorer(const string& mark, const SearchServer& search_server, const vector<string>& queries, ScorePrecision precision) {
+    const CompactScorer scorer(search_server, precision);
+    {
+        LOG_DURATION(mark);
+        double total_relevance = 0;
+        for (const string_view query : queries) {
+            for (const auto& document : scorer.FindTopDocuments(query)) {
+                total_relevance += document.relevance;
+            }
+        }
+        cout << total_relevance << endl;
+    }
+    cout << mark << " postings: "s << scorer.GetPostingBytes() << " bytes, agreement: "s
+         << scorer.CompareWithDoublePrecision(queries) << endl;
+}
+ 
 int main() {
     mt19937 generator;
     const auto dictionary = GenerateDictionary(generator, 1000, 10);
@@ -75,7 +52,25 @@ int main() {
     for (size_t i = 0; i < documents.size(); ++i) {
         search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, {1, 2, 3});
     }
+    cout << search_server.GetMemoryStats() << endl;
     const auto queries = GenerateQueries(generator, dictionary, 100, 70);
     TEST(seq);
     TEST(par);
+    TestCompactScorer("float"s, search_server, queries, ScorePrecision::FLOAT);
+    TestCompactScorer("fixed16"s, search_server, queries, ScorePrecision::FIXED16);
+    RequestQueue request_queue(search_server);
+    ProcessQueries(request_queue, queries);
+    cout << request_queue.GetStats() << endl;
+    size_t page_count = 0;
+    size_t paged_document_count = 0;
+    for (const auto& page : PaginateLazily([&search_server, &queries](const SearchCursor& cursor) {
+             return search_server.FindTopDocuments(queries[0], cursor, 100);
+         })) {
+        ++page_count;
+        paged_document_count += page.size();
+    }
+    cout << "pages: "s << page_count << ", documents: "s << paged_document_count << endl;
+    for (const auto& latency : CollectTraceSnapshot()) {
+        cout << latency << endl;
+    }
 }
\ No newline at end of file
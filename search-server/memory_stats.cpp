@@ -0,0 +1,49 @@
+#include "memory_stats.h"
+
+using namespace std::string_literals;
+
+AllocationCounter& AllocationCounters::Get(MemoryCategory category) {
+    return counters_[static_cast<size_t>(category)];
+}
+
+const AllocationCounter& AllocationCounters::Get(MemoryCategory category) const {
+    return counters_[static_cast<size_t>(category)];
+}
+
+AllocationCounter& GetDefaultAllocationCounter(MemoryCategory category) {
+    static AllocationCounters counters;
+    return counters.Get(category);
+}
+
+size_t MemoryStats::GetEstimatedBytes() const {
+    return documents.estimated_bytes + document_ids.estimated_bytes
+         + inverted_index.estimated_bytes + forward_index.estimated_bytes
+         + dictionary.estimated_bytes + stop_words.estimated_bytes + impact_index.estimated_bytes;
+}
+
+int64_t MemoryStats::GetAllocatedBytes() const {
+    return documents.allocated_bytes + document_ids.allocated_bytes
+         + inverted_index.allocated_bytes + forward_index.allocated_bytes
+         + dictionary.allocated_bytes + stop_words.allocated_bytes + impact_index.allocated_bytes;
+}
+
+std::ostream& operator<<(std::ostream& out, const MemoryUsage& usage) {
+    out << "{ entries = "s << usage.entries
+        << ", estimated_bytes = "s << usage.estimated_bytes
+        << ", allocated_bytes = "s << usage.allocated_bytes
+        << ", allocated_blocks = "s << usage.allocated_blocks << " }"s;
+    return out;
+}
+
+std::ostream& operator<<(std::ostream& out, const MemoryStats& stats) {
+    out << "documents: "s << stats.documents << '\n'
+        << "document_ids: "s << stats.document_ids << '\n'
+        << "inverted_index: "s << stats.inverted_index << '\n'
+        << "forward_index: "s << stats.forward_index << '\n'
+        << "dictionary: "s << stats.dictionary << '\n'
+        << "stop_words: "s << stats.stop_words << '\n'
+        << "impact_index: "s << stats.impact_index << '\n'
+        << "total: estimated_bytes = "s << stats.GetEstimatedBytes()
+        << ", allocated_bytes = "s << stats.GetAllocatedBytes();
+    return out;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <type_traits>
+#include <vector>
+
+enum class MemoryCategory {
+    DOCUMENTS,
+    DOCUMENT_IDS,
+    INVERTED_INDEX,
+    FORWARD_INDEX,
+    DICTIONARY,
+    STOP_WORDS,
+    IMPACT_INDEX,
+};
+
+constexpr size_t MEMORY_CATEGORY_COUNT = 7;
+
+struct AllocationCounter {
+    std::atomic<int64_t> bytes = 0;
+    std::atomic<int64_t> blocks = 0;
+};
+
+// Счётчики одного владельца (экземпляра SearchServer) по всем категориям.
+class AllocationCounters {
+public:
+    AllocationCounter& Get(MemoryCategory category);
+    const AllocationCounter& Get(MemoryCategory category) const;
+
+private:
+    std::array<AllocationCounter, MEMORY_CATEGORY_COUNT> counters_;
+};
+
+// Общий для процесса счётчик контейнеров, созданных без явного аллокатора.
+AllocationCounter& GetDefaultAllocationCounter(MemoryCategory category);
+
+// Аллокатор хранит указатель на счётчик своей категории; счётчики должны
+// пережить все контейнеры, созданные с этим аллокатором.
+template <typename T, MemoryCategory Category>
+class CountingAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = CountingAllocator<U, Category>;
+    };
+
+    CountingAllocator() noexcept
+        : counter_(&GetDefaultAllocationCounter(Category)) {
+    }
+    CountingAllocator(AllocationCounters& counters) noexcept
+        : counter_(&counters.Get(Category)) {
+    }
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U, Category>& other) noexcept
+        : counter_(other.counter_) {
+    }
+
+    T* allocate(size_t n) {
+        T* result = std::allocator<T>{}.allocate(n);
+        counter_->bytes.fetch_add(static_cast<int64_t>(n * sizeof(T)), std::memory_order_relaxed);
+        counter_->blocks.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        counter_->bytes.fetch_sub(static_cast<int64_t>(n * sizeof(T)), std::memory_order_relaxed);
+        counter_->blocks.fetch_sub(1, std::memory_order_relaxed);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    const AllocationCounter* GetCounter() const noexcept {
+        return counter_;
+    }
+
+private:
+    template <typename U, MemoryCategory>
+    friend class CountingAllocator;
+
+    AllocationCounter* counter_;
+};
+
+template <typename T, typename U, MemoryCategory Category>
+bool operator==(const CountingAllocator<T, Category>& lhs, const CountingAllocator<U, Category>& rhs) noexcept {
+    return lhs.GetCounter() == rhs.GetCounter();
+}
+
+template <typename T, typename U, MemoryCategory Category>
+bool operator!=(const CountingAllocator<T, Category>& lhs, const CountingAllocator<U, Category>& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+template <typename Key, typename Value, MemoryCategory Category, typename Compare = std::less<Key>>
+using CountedMap = std::map<Key, Value, Compare, CountingAllocator<std::pair<const Key, Value>, Category>>;
+
+template <typename Key, MemoryCategory Category, typename Compare = std::less<Key>>
+using CountedSet = std::set<Key, Compare, CountingAllocator<Key, Category>>;
+
+template <typename T, MemoryCategory Category>
+using CountedVector = std::vector<T, CountingAllocator<T, Category>>;
+
+// Все поля относятся к одному экземпляру SearchServer: entries и estimated_bytes —
+// оценка по содержимому (узлы дерева без накладных расходов malloc),
+// allocated_* — точные данные CountingAllocator с его счётчиками.
+struct MemoryUsage {
+    size_t entries = 0;
+    size_t estimated_bytes = 0;
+    int64_t allocated_bytes = 0;
+    int64_t allocated_blocks = 0;
+};
+
+struct MemoryStats {
+    MemoryUsage documents;
+    MemoryUsage document_ids;
+    MemoryUsage inverted_index;
+    MemoryUsage forward_index;
+    MemoryUsage dictionary;
+    MemoryUsage stop_words;
+    MemoryUsage impact_index;
+
+    size_t GetEstimatedBytes() const;
+    int64_t GetAllocatedBytes() const;
+};
+
+std::ostream& operator<<(std::ostream& out, const MemoryUsage& usage);
+std::ostream& operator<<(std::ostream& out, const MemoryStats& stats);
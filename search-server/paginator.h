@@ -3,6 +3,10 @@
 #include <vector>
 #include <cassert>
 #include <iostream>
+#include <iterator>
+#include <utility>
+
+#include "search_cursor.h"
  
 template <typename IteratorRanges>
 class IteratorRange {
@@ -63,4 +67,73 @@ private:
 template <typename Container>
 auto Paginate(const Container& c, size_t page_size) {
     return Paginator(begin(c), end(c), page_size);
-}
\ No newline at end of file
+}
+ 
+// Ленивая выдача по курсору: очередная страница запрашивается у источника
+// только при переходе к ней. PageSource — SearchPage(const SearchCursor&).
+template <typename PageSource>
+class LazyPaginator {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::vector<Document>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+        
+        Iterator() = default;
+        explicit Iterator(const PageSource* source) : source_(source) {
+            Fetch(SearchCursor{});
+        }
+        
+        reference operator*() const {
+            return page_.documents;
+        }
+        pointer operator->() const {
+            return &page_.documents;
+        }
+        
+        Iterator& operator++() {
+            if (page_.next.IsEnd()) {
+                source_ = nullptr;
+            } else {
+                Fetch(page_.next);
+            }
+            return *this;
+        }
+        
+        bool operator==(const Iterator& other) const {
+            return source_ == other.source_;
+        }
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+    private:
+        const PageSource* source_ = nullptr;
+        SearchPage page_;
+        
+        void Fetch(const SearchCursor& cursor) {
+            page_ = (*source_)(cursor);
+            if (page_.documents.empty()) {
+                source_ = nullptr;
+            }
+        }
+    };
+    
+    explicit LazyPaginator(PageSource source) : source_(std::move(source)) {}
+    
+    Iterator begin() const {
+        return Iterator(&source_);
+    }
+    Iterator end() const {
+        return Iterator();
+    }
+private:
+    PageSource source_;
+};
+ 
+template <typename PageSource>
+auto PaginateLazily(PageSource source) {
+    return LazyPaginator<PageSource>(std::move(source));
+}
@@ -18,6 +18,20 @@ std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_ser
     return helper;
 }
 
+std::vector<std::vector<Document>> ProcessQueries(RequestQueue& request_queue,
+    const std::vector<std::string>& queries){
+    
+    std::vector<std::vector<Document>> helper(queries.size());
+    std::transform(std::execution::par, 
+                   queries.begin(), 
+                   queries.end(), 
+                   helper.begin(),
+                   [&request_queue](const std::string& query){
+                        return request_queue.AddFindRequest(query);
+                    });
+    return helper;
+}
+
 std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server,
     const std::vector<std::string>& queries){
  
@@ -32,4 +46,30 @@ std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server,
                                  [&search_server](auto& query){ 
                                      return search_server.FindTopDocuments(query); 
                                  });
-}
\ No newline at end of file
+}
+
+std::vector<SearchResult> ProcessQueries(const SearchServer& search_server,
+                                         const std::vector<std::string>& queries,
+                                         SearchControl::Clock::time_point deadline,
+                                         const CancellationToken& cancellation) {
+    const SearchControl control{deadline, cancellation};
+    std::vector<SearchResult> helper(queries.size());
+    std::transform(std::execution::par,
+                   queries.begin(),
+                   queries.end(),
+                   helper.begin(),
+                   [&search_server, &control](const std::string& query) {
+                       return search_server.FindTopDocuments(control, query);
+                   });
+    return helper;
+}
+
+std::future<SearchResult> FindTopDocumentsAsync(const SearchServer& search_server,
+                                                std::string raw_query,
+                                                SearchControl control,
+                                                DocumentStatus status) {
+    return std::async(std::launch::async,
+                      [&search_server, raw_query = std::move(raw_query), control = std::move(control), status] {
+                          return search_server.FindTopDocuments(control, raw_query, status);
+                      });
+}
@@ -1,10 +1,29 @@
 #pragma once
 #include "search_server.h" 
+#include "request_queue.h"
+#include <chrono>
+#include <future>
 #include <vector>
 #include <string>
  
 std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server,
                                                   const std::vector<std::string>& queries); 
 
+// Каждый запрос учитывается в статистике request_queue.
+std::vector<std::vector<Document>> ProcessQueries(RequestQueue& request_queue,
+                                                  const std::vector<std::string>& queries);
+
 std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server,
-    const std::vector<std::string>& queries);
\ No newline at end of file
+    const std::vector<std::string>& queries);
+
+// Общий дедлайн на весь пакет: запросы, не успевшие начаться, получают TIMEOUT.
+std::vector<SearchResult> ProcessQueries(const SearchServer& search_server,
+                                         const std::vector<std::string>& queries,
+                                         SearchControl::Clock::time_point deadline,
+                                         const CancellationToken& cancellation = {});
+
+// SearchServer должен жить до получения результата.
+std::future<SearchResult> FindTopDocumentsAsync(const SearchServer& search_server,
+                                                std::string raw_query,
+                                                SearchControl control,
+                                                DocumentStatus status = DocumentStatus::ACTUAL);
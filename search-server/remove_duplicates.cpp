@@ -5,13 +5,10 @@ void RemoveDuplicates(SearchServer& search_server) {
     std::set<int> id_remove;
     std::map<std::set<std::string>, int> unique_word_plus_id;
     for (const int document_id : search_server) {
-        std::map<std::string, double> all_words;
- 
-        all_words = search_server.GetWordFrequencies(document_id);
         std::set<std::string> unique_words;
  
-        for (auto [word, _] : all_words) {
-            unique_words.insert(word);
+        for (auto [word, _] : search_server.GetWordFrequencies(document_id)) {
+            unique_words.insert(std::string(word));
         }
  
         if (unique_word_plus_id.count(unique_words)) {
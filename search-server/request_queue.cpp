@@ -1,13 +1,213 @@
 #include "request_queue.h"
+#include <algorithm>
+#include <string>
+#include <thread>
  
-std::vector<Document> RequestQueue::AddFindRequest(std::string_view& raw_query, DocumentStatus status) {
-    return AddFindRequest(raw_query, [&status](int document_id, DocumentStatus document_status, int rating) {return document_status == status;});
+namespace {
+ 
+template <typename Counter>
+void Increment(std::atomic<Counter>& counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+ 
+}  // namespace
+ 
+uint64_t RequestStats::GetLatencyPercentileMicros(double percentile) const {
+    if (requests == 0) {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(percentile * requests + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+        seen += latency_buckets[i];
+        if (seen >= rank) {
+            return uint64_t{1} << i;
+        }
+    }
+    return uint64_t{1} << (LATENCY_BUCKET_COUNT - 1);
+}
+ 
+std::ostream& operator<<(std::ostream& out, const RequestStats& stats) {
+    using namespace std::string_literals;
+    out << "requests: "s << stats.requests << ", no result: "s << stats.no_result_requests
+        << ", latency p50 < "s << stats.GetLatencyPercentileMicros(0.5) << " us"s
+        << ", p99 < "s << stats.GetLatencyPercentileMicros(0.99) << " us"s;
+    return out;
+}
+ 
+RequestQueue::RequestQueue(const SearchServer& search_server, std::chrono::minutes window)
+    : search_request(search_server)
+    , slot_count_(static_cast<size_t>(std::max<std::chrono::minutes::rep>(window.count(), 1)))
+    , slots_(std::make_unique<Slot[]>(slot_count_)) {
+}
+ 
+std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query, DocumentStatus status) {
+    return AddFindRequest(raw_query, [status](int, DocumentStatus document_status, int) {return document_status == status;});
 }
     
-std::vector<Document> RequestQueue::AddFindRequest(std::string_view& raw_query) {
+std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query) {
     return AddFindRequest(raw_query, DocumentStatus::ACTUAL);
 }
+ 
+void RequestQueue::RecordRequest(Clock::time_point time, Clock::duration latency, size_t result_count) {
+    const int64_t minute = ToMinute(time);
+    Slot& slot = GetSlot(minute);
+    const size_t stripe_index = GetStripeIndex();
+    Stripe& stripe = slot.stripes[stripe_index];
+    
+    while (!TryEnterSlot(slot, stripe, minute)) {
+        std::lock_guard guard(rollover_mutex_);
+        AdvanceTo(minute);
+        if (minute <= latest_minute_ - static_cast<int64_t>(slot_count_)) {
+            return;  // запись старше окна
+        }
+        // слот минуты из окна может быть занят только ею самой
+        if (slot.minute.load(std::memory_order_relaxed) == EMPTY_MINUTE) {
+            slot.minute.store(minute, std::memory_order_seq_cst);
+        }
+    }
+    
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    size_t latency_bucket = 0;
+    while (latency_bucket + 1 < RequestStats::LATENCY_BUCKET_COUNT
+           && (int64_t{1} << latency_bucket) <= micros) {
+        ++latency_bucket;
+    }
+    const size_t result_bucket = std::min(result_count, RequestStats::RESULT_BUCKET_COUNT - 1);
+    
+    TotalStripe& total = totals_[stripe_index];
+    Increment(stripe.requests);
+    Increment(total.requests);
+    if (result_count == 0) {
+        Increment(stripe.no_result_requests);
+        Increment(total.no_result_requests);
+    }
+    Increment(stripe.latency_buckets[latency_bucket]);
+    Increment(total.latency_buckets[latency_bucket]);
+    Increment(stripe.result_counts[result_bucket]);
+    Increment(total.result_counts[result_bucket]);
+    stripe.writers.fetch_sub(1, std::memory_order_release);
+}
     
 int RequestQueue::GetNoResultRequests() const {
-    return count_if(requests_.begin(), requests_.end(), [](QueryResult query){return query.query_result == 0;});
-}
\ No newline at end of file
+    return static_cast<int>(GetStats().no_result_requests);
+}
+ 
+RequestStats RequestQueue::GetStats() const {
+    return GetStats(Clock::now(), std::chrono::minutes(slot_count_));
+}
+ 
+RequestStats RequestQueue::GetStats(Clock::time_point now, std::chrono::minutes window) const {
+    const int64_t last_minute = ToMinute(now);
+    const int64_t window_size = std::clamp<int64_t>(window.count(), 0, slot_count_);
+    
+    RequestStats stats;
+    std::lock_guard guard(rollover_mutex_);
+    AdvanceTo(last_minute);
+    if (last_minute == latest_minute_ && window_size == static_cast<int64_t>(slot_count_)) {
+        for (const TotalStripe& total : totals_) {
+            AddCounters(total, stats);
+        }
+        return stats;
+    }
+    // под мьютексом минуты слотов не меняются
+    const int64_t first_minute = std::max(last_minute - window_size,
+                                          latest_minute_ - static_cast<int64_t>(slot_count_)) + 1;
+    for (int64_t minute = first_minute; minute <= last_minute; ++minute) {
+        const Slot& slot = GetSlot(minute);
+        if (slot.minute.load(std::memory_order_relaxed) != minute) {
+            continue;
+        }
+        for (const Stripe& stripe : slot.stripes) {
+            AddCounters(stripe, stats);
+        }
+    }
+    return stats;
+}
+ 
+int64_t RequestQueue::ToMinute(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::minutes>(time.time_since_epoch()).count();
+}
+ 
+RequestQueue::Slot& RequestQueue::GetSlot(int64_t minute) const {
+    const int64_t slot_count = static_cast<int64_t>(slot_count_);
+    return slots_[static_cast<size_t>((minute % slot_count + slot_count) % slot_count)];
+}
+ 
+// Пара seq_cst-операций с EvictSlot: либо вытеснение видит writers > 0 и ждёт,
+// либо запись видит сменившуюся минуту и уходит под мьютекс.
+bool RequestQueue::TryEnterSlot(Slot& slot, Stripe& stripe, int64_t minute) {
+    if (slot.minute.load(std::memory_order_acquire) != minute) {
+        return false;
+    }
+    stripe.writers.fetch_add(1, std::memory_order_seq_cst);
+    if (slot.minute.load(std::memory_order_seq_cst) == minute) {
+        return true;
+    }
+    stripe.writers.fetch_sub(1, std::memory_order_release);
+    return false;
+}
+ 
+// Вызывается под rollover_mutex_. Вытесняет минуты (latest_minute_ - n, minute - n],
+// но не больше n слотов, поэтому долгий простой обходится одним проходом по кольцу.
+void RequestQueue::AdvanceTo(int64_t minute) const {
+    if (minute <= latest_minute_) {
+        return;
+    }
+    const int64_t slot_count = static_cast<int64_t>(slot_count_);
+    const int64_t first_minute = std::max(latest_minute_, minute - slot_count) - slot_count + 1;
+    for (int64_t evicted = first_minute; evicted <= minute - slot_count; ++evicted) {
+        // после долгого простоя в слоте может быть и более ранняя минута
+        Slot& slot = GetSlot(evicted);
+        const int64_t slot_minute = slot.minute.load(std::memory_order_relaxed);
+        if (slot_minute != EMPTY_MINUTE && slot_minute <= evicted) {
+            EvictSlot(slot);
+        }
+    }
+    latest_minute_ = minute;
+}
+ 
+// Вызывается под rollover_mutex_.
+void RequestQueue::EvictSlot(Slot& slot) const {
+    slot.minute.store(RESETTING_MINUTE, std::memory_order_seq_cst);
+    for (const Stripe& stripe : slot.stripes) {
+        while (stripe.writers.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+    }
+    const auto subtract = [](std::atomic<uint32_t>& slot_counter, std::atomic<uint64_t>& total_counter) {
+        total_counter.fetch_sub(slot_counter.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        slot_counter.store(0, std::memory_order_relaxed);
+    };
+    for (size_t i = 0; i < STRIPE_COUNT; ++i) {
+        Stripe& stripe = slot.stripes[i];
+        TotalStripe& total = totals_[i];
+        subtract(stripe.requests, total.requests);
+        subtract(stripe.no_result_requests, total.no_result_requests);
+        for (size_t j = 0; j < RequestStats::LATENCY_BUCKET_COUNT; ++j) {
+            subtract(stripe.latency_buckets[j], total.latency_buckets[j]);
+        }
+        for (size_t j = 0; j < RequestStats::RESULT_BUCKET_COUNT; ++j) {
+            subtract(stripe.result_counts[j], total.result_counts[j]);
+        }
+    }
+    slot.minute.store(EMPTY_MINUTE, std::memory_order_release);
+}
+ 
+template <typename Counter>
+void RequestQueue::AddCounters(const Counters<Counter>& counters, RequestStats& stats) {
+    stats.requests += counters.requests.load(std::memory_order_relaxed);
+    stats.no_result_requests += counters.no_result_requests.load(std::memory_order_relaxed);
+    for (size_t j = 0; j < RequestStats::LATENCY_BUCKET_COUNT; ++j) {
+        stats.latency_buckets[j] += counters.latency_buckets[j].load(std::memory_order_relaxed);
+    }
+    for (size_t j = 0; j < RequestStats::RESULT_BUCKET_COUNT; ++j) {
+        stats.result_counts[j] += counters.result_counts[j].load(std::memory_order_relaxed);
+    }
+}
+ 
+size_t RequestQueue::GetStripeIndex() {
+    static std::atomic<size_t> next_stripe = 0;
+    thread_local const size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % STRIPE_COUNT;
+    return stripe;
+}
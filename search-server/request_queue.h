@@ -1,36 +1,110 @@
 #pragma once
 #include "search_server.h"
-#include <deque>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <memory>
+#include <mutex>
  
+struct RequestStats {
+    static constexpr size_t LATENCY_BUCKET_COUNT = 24;
+    static constexpr size_t RESULT_BUCKET_COUNT = 6;
+ 
+    uint64_t requests = 0;
+    uint64_t no_result_requests = 0;
+    // latency_buckets[i] — запросы с задержкой меньше 2^i мкс (последняя корзина — все остальные)
+    std::array<uint64_t, LATENCY_BUCKET_COUNT> latency_buckets{};
+    // result_counts[i] — запросы с i найденными документами (последняя — i и больше)
+    std::array<uint64_t, RESULT_BUCKET_COUNT> result_counts{};
+ 
+    // Верхняя граница корзины, в которую попал перцентиль.
+    uint64_t GetLatencyPercentileMicros(double percentile) const;
+};
+ 
+std::ostream& operator<<(std::ostream& out, const RequestStats& stats);
+ 
+// Статистика запросов за скользящее окно реального времени (по умолчанию сутки).
+// Кольцо из поминутных слотов и итоги по всему окну. Запись в слот своей минуты —
+// атомарные инкременты в полосу слота и в полосу итогов, полоса выбирается по потоку.
+// Смена минуты идёт под мьютексом: вышедшие из окна слоты вычитаются из итогов
+// и обнуляются, причём вытесняющий поток дожидается уже начатых в слот записей;
+// запись, заставшая свой слот не готовым, тоже проходит через мьютекс.
+// GetStats за всё окно читает только итоги, за меньшее — по слоту на минуту.
+// Время вызова GetStats тоже сдвигает окно: более старые записи затем отбрасываются.
+// Безопасен для одновременного вызова из любого числа потоков.
 class RequestQueue {
 public:
-    RequestQueue(const SearchServer& search_server) : search_request(search_server){}  
+    using Clock = std::chrono::steady_clock;
+ 
+    explicit RequestQueue(const SearchServer& search_server,
+                          std::chrono::minutes window = std::chrono::minutes(1440));
     
     template <typename DocumentPredicate>
-    std::vector<Document> AddFindRequest(std::string_view& raw_query, DocumentPredicate document_predicate);
-    std::vector<Document> AddFindRequest(std::string_view& raw_query, DocumentStatus status);
-    std::vector<Document> AddFindRequest(std::string_view& raw_query);
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentPredicate document_predicate);
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentStatus status);
+    std::vector<Document> AddFindRequest(std::string_view raw_query);
+    
+    void RecordRequest(Clock::time_point time, Clock::duration latency, size_t result_count);
     
     int GetNoResultRequests() const;
+    RequestStats GetStats() const;
+    RequestStats GetStats(Clock::time_point now, std::chrono::minutes window) const;
 private:
-    struct QueryResult {
-        bool query_result;
+    static constexpr size_t STRIPE_COUNT = 4;
+    
+    template <typename Counter>
+    struct Counters {
+        std::atomic<Counter> requests = 0;
+        std::atomic<Counter> no_result_requests = 0;
+        std::array<std::atomic<Counter>, RequestStats::LATENCY_BUCKET_COUNT> latency_buckets{};
+        std::array<std::atomic<Counter>, RequestStats::RESULT_BUCKET_COUNT> result_counts{};
+    };
+    
+    struct alignas(64) Stripe : Counters<uint32_t> {
+        // записи, начатые в этой полосе; вытеснение слота ждёт, пока их не станет
+        std::atomic<uint32_t> writers = 0;
     };
+    
+    struct alignas(64) TotalStripe : Counters<uint64_t> {
+    };
+    
+    // minute слота: номер минуты, EMPTY_MINUTE или RESETTING_MINUTE.
+    // Меняется только под rollover_mutex_.
+    static constexpr int64_t EMPTY_MINUTE = std::numeric_limits<int64_t>::min();
+    static constexpr int64_t RESETTING_MINUTE = EMPTY_MINUTE + 1;
+    
+    struct Slot {
+        std::atomic<int64_t> minute = EMPTY_MINUTE;
+        std::array<Stripe, STRIPE_COUNT> stripes;
+    };
+    
     const SearchServer& search_request;
-    std::deque<QueryResult> requests_;
-    const static int min_in_day_ = 1440;
+    const size_t slot_count_;
+    std::unique_ptr<Slot[]> slots_;
+    // сумма слотов с минутами из (latest_minute_ - slot_count_, latest_minute_]
+    mutable std::array<TotalStripe, STRIPE_COUNT> totals_;
+    mutable std::mutex rollover_mutex_;
+    mutable int64_t latest_minute_ = 0;
+    
+    static int64_t ToMinute(Clock::time_point time);
+    Slot& GetSlot(int64_t minute) const;
+    static bool TryEnterSlot(Slot& slot, Stripe& stripe, int64_t minute);
+    void AdvanceTo(int64_t minute) const;
+    void EvictSlot(Slot& slot) const;
+    template <typename Counter>
+    static void AddCounters(const Counters<Counter>& counters, RequestStats& stats);
+    static size_t GetStripeIndex();
 }; 
  
 template <typename DocumentPredicate>
-std::vector<Document> RequestQueue::AddFindRequest(std::string_view& raw_query, DocumentPredicate document_predicate) {
+std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query, DocumentPredicate document_predicate) {
+    const auto start_time = Clock::now();
     std::vector<Document> helper = search_request.FindTopDocuments(raw_query, document_predicate);
+    const auto end_time = Clock::now();
  
-    QueryResult query;
-    query.query_result = (helper.empty() == false);
- 
-    if (!(requests_.size() < min_in_day_)){
-        requests_.pop_front();
-    } 
-    requests_.push_back(query); 
+    RecordRequest(end_time, end_time - start_time, helper.size());
     return helper;
-}
\ No newline at end of file
+}
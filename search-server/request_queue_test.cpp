@@ -0,0 +1,155 @@
+#include <chrono>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "request_queue.h"
+#include "test_framework.h"
+
+using namespace std;
+
+namespace {
+
+RequestQueue::Clock::time_point AtMinute(int64_t minute, int second = 0) {
+    return RequestQueue::Clock::time_point(chrono::minutes(minute) + chrono::seconds(second));
+}
+
+}  // namespace
+
+void TestWindow() {
+    const SearchServer search_server("и в на"s);
+    RequestQueue queue(search_server, chrono::minutes(3));
+    queue.RecordRequest(AtMinute(10), chrono::microseconds(3), 0);
+    queue.RecordRequest(AtMinute(11, 30), chrono::microseconds(100), 2);
+    queue.RecordRequest(AtMinute(12), chrono::microseconds(100), 7);
+
+    const RequestStats stats = queue.GetStats(AtMinute(12, 59), chrono::minutes(3));
+    ASSERT_EQUAL(stats.requests, 3u);
+    ASSERT_EQUAL(stats.no_result_requests, 1u);
+    ASSERT_EQUAL(stats.result_counts[2], 1u);
+    ASSERT_EQUAL(stats.result_counts[RequestStats::RESULT_BUCKET_COUNT - 1], 1u);
+    ASSERT_EQUAL(stats.latency_buckets[2], 1u);
+    ASSERT_EQUAL(queue.GetStats(AtMinute(12), chrono::minutes(1)).requests, 1u);
+
+    // минута 13 занимает слот минуты 10
+    queue.RecordRequest(AtMinute(13), chrono::microseconds(1), 1);
+    ASSERT_EQUAL(queue.GetStats(AtMinute(13), chrono::minutes(3)).requests, 3u);
+    // запись старше окна отбрасывается
+    queue.RecordRequest(AtMinute(10), chrono::microseconds(1), 1);
+    ASSERT_EQUAL(queue.GetStats(AtMinute(13), chrono::minutes(3)).requests, 3u);
+}
+
+void TestConcurrentMinuteChange() {
+    constexpr int THREAD_COUNT = 8;
+    constexpr int MINUTE_COUNT = 200;
+    constexpr int REQUESTS_PER_MINUTE = 50;
+
+    const SearchServer search_server("и в на"s);
+    // один слот: каждая новая минута сбрасывает его, пока другие потоки пишут
+    RequestQueue queue(search_server, chrono::minutes(1));
+    vector<thread> threads;
+    for (int t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&queue] {
+            for (int minute = 0; minute < MINUTE_COUNT; ++minute) {
+                for (int i = 0; i < REQUESTS_PER_MINUTE; ++i) {
+                    queue.RecordRequest(AtMinute(minute), chrono::microseconds(1), 1);
+                }
+            }
+        });
+    }
+    // чтение сдвигает окно и вытесняет слот, пока в него пишут;
+    // до последней минуты читатель не доходит
+    for (int i = 0; i < 1000; ++i) {
+        const RequestStats stats = queue.GetStats(AtMinute(i * (MINUTE_COUNT - 1) / 1000), chrono::minutes(1));
+        ASSERT(stats.requests <= static_cast<uint64_t>(THREAD_COUNT * REQUESTS_PER_MINUTE));
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+
+    // все записи последней минуты сделаны после последнего сброса
+    const RequestStats stats = queue.GetStats(AtMinute(MINUTE_COUNT - 1), chrono::minutes(1));
+    ASSERT_EQUAL(stats.requests, static_cast<uint64_t>(THREAD_COUNT * REQUESTS_PER_MINUTE));
+    ASSERT_EQUAL(stats.result_counts[1], static_cast<uint64_t>(THREAD_COUNT * REQUESTS_PER_MINUTE));
+}
+
+// Итоги окна сверяются с поминутной моделью и с суммой чтений по одной минуте.
+void TestTotalsMatchSlots() {
+    constexpr int WINDOW = 5;
+    const SearchServer search_server("и в на"s);
+    RequestQueue queue(search_server, chrono::minutes(WINDOW));
+    map<int64_t, RequestStats> expected_by_minute;
+    int64_t latest_minute = 0;
+    mt19937 generator(3);
+
+    for (int step = 0; step < 2000; ++step) {
+        const int64_t minute = max<int64_t>(0, latest_minute + uniform_int_distribution<int>(-WINDOW - 1, 2)(generator));
+        const size_t result_count = uniform_int_distribution<size_t>(0, 7)(generator);
+        const auto latency = chrono::microseconds(uniform_int_distribution<int>(0, 5000)(generator));
+        queue.RecordRequest(AtMinute(minute, step % 60), latency, result_count);
+        latest_minute = max(latest_minute, minute);
+        if (minute > latest_minute - WINDOW) {
+            RequestStats& expected = expected_by_minute[minute];
+            ++expected.requests;
+            expected.no_result_requests += result_count == 0 ? 1 : 0;
+            ++expected.result_counts[min(result_count, RequestStats::RESULT_BUCKET_COUNT - 1)];
+        }
+        if (step % 10 != 0) {
+            continue;
+        }
+
+        RequestStats expected;
+        for (int64_t m = latest_minute - WINDOW + 1; m <= latest_minute; ++m) {
+            expected.requests += expected_by_minute[m].requests;
+            expected.no_result_requests += expected_by_minute[m].no_result_requests;
+            for (size_t j = 0; j < RequestStats::RESULT_BUCKET_COUNT; ++j) {
+                expected.result_counts[j] += expected_by_minute[m].result_counts[j];
+            }
+        }
+        const RequestStats totals = queue.GetStats(AtMinute(latest_minute, 59), chrono::minutes(WINDOW));
+        RequestStats by_minute;
+        for (int64_t m = latest_minute - WINDOW + 1; m <= latest_minute; ++m) {
+            const RequestStats slot = queue.GetStats(AtMinute(m), chrono::minutes(1));
+            by_minute.requests += slot.requests;
+            for (size_t j = 0; j < RequestStats::LATENCY_BUCKET_COUNT; ++j) {
+                by_minute.latency_buckets[j] += slot.latency_buckets[j];
+            }
+        }
+        ASSERT_EQUAL(totals.requests, expected.requests);
+        ASSERT_EQUAL(totals.no_result_requests, expected.no_result_requests);
+        ASSERT(totals.result_counts == expected.result_counts);
+        ASSERT_EQUAL(by_minute.requests, expected.requests);
+        ASSERT(by_minute.latency_buckets == totals.latency_buckets);
+    }
+}
+
+void TestIdleExpiry() {
+    const SearchServer search_server("и в на"s);
+    RequestQueue queue(search_server, chrono::minutes(3));
+    for (int minute = 0; minute < 3; ++minute) {
+        queue.RecordRequest(AtMinute(minute), chrono::microseconds(1), 0);
+    }
+    ASSERT_EQUAL(queue.GetStats(AtMinute(2), chrono::minutes(3)).no_result_requests, 3u);
+    // без новых записей окно уходит вперёд при чтении
+    ASSERT_EQUAL(queue.GetStats(AtMinute(4), chrono::minutes(3)).requests, 1u);
+    ASSERT_EQUAL(queue.GetStats(AtMinute(100'000), chrono::minutes(3)).requests, 0u);
+    // после чтения окно не возвращается назад
+    queue.RecordRequest(AtMinute(2), chrono::microseconds(1), 0);
+    ASSERT_EQUAL(queue.GetStats(AtMinute(100'000), chrono::minutes(3)).requests, 0u);
+    queue.RecordRequest(AtMinute(100'000), chrono::microseconds(1), 0);
+    ASSERT_EQUAL(queue.GetStats(AtMinute(100'000), chrono::minutes(3)).requests, 1u);
+
+    RequestQueue live_queue(search_server);
+    for (int i = 0; i < 5; ++i) {
+        live_queue.AddFindRequest("кот"s);
+    }
+    ASSERT_EQUAL(live_queue.GetNoResultRequests(), 5);
+}
+
+int main() {
+    RUN_TEST(TestWindow);
+    RUN_TEST(TestConcurrentMinuteChange);
+    RUN_TEST(TestTotalsMatchSlots);
+    RUN_TEST(TestIdleExpiry);
+}
@@ -0,0 +1,388 @@
+#include "search_server.h"
+#include "process_queries.h"
+#include "query_generator.h"
+#include "remove_duplicates.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+struct Scenario {
+    int document_count = 10'000;
+    int dictionary_size = 1'000;
+    int max_word_length = 10;
+    int document_words = 70;
+    int query_words = 5;
+    double minus_probability = 0.0;
+    int query_count = 500;
+};
+
+struct Options {
+    vector<int> document_counts = {1'000, 10'000};
+    vector<int> dictionary_sizes = {1'000, 10'000};
+    vector<int> query_words = {3, 10};
+    vector<double> minus_probabilities = {0.0, 0.2};
+    int document_words = 70;
+    int query_count = 500;
+    int repetitions = 5;
+    unsigned seed = 42;
+    string output;
+};
+
+// Время одной операции в наносекундах по всем повторениям.
+struct Summary {
+    double median = 0;
+    double mean = 0;
+    double stddev = 0;
+    double min = 0;
+    double max = 0;
+    // полуширина 95% доверительного интервала среднего (нормальное приближение)
+    double ci95 = 0;
+};
+
+struct Result {
+    string name;
+    Scenario scenario;
+    size_t operations = 0;
+    Summary ns_per_op;
+    double checksum = 0;
+};
+
+struct Corpus {
+    vector<string> documents;
+    vector<vector<int>> ratings;
+    vector<string> queries;
+};
+
+Summary Summarize(vector<double> samples) {
+    Summary summary;
+    sort(samples.begin(), samples.end());
+    const size_t n = samples.size();
+    summary.min = samples.front();
+    summary.max = samples.back();
+    summary.median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    summary.mean = accumulate(samples.begin(), samples.end(), 0.0) / n;
+    if (n > 1) {
+        double square_sum = 0;
+        for (const double sample : samples) {
+            square_sum += (sample - summary.mean) * (sample - summary.mean);
+        }
+        summary.stddev = sqrt(square_sum / (n - 1));
+        summary.ci95 = 1.96 * summary.stddev / sqrt(static_cast<double>(n));
+    }
+    return summary;
+}
+
+// Каждый 10-й документ повторяет слова предыдущего в другом порядке — работа для RemoveDuplicates.
+Corpus GenerateCorpus(const Scenario& scenario, unsigned seed) {
+    mt19937 generator(seed);
+    const auto dictionary = GenerateDictionary(generator, scenario.dictionary_size, scenario.max_word_length);
+    Corpus corpus;
+    corpus.documents.reserve(scenario.document_count);
+    for (int id = 0; id < scenario.document_count; ++id) {
+        if (id % 10 == 9) {
+            auto words = SplitIntoWords(corpus.documents.back());
+            reverse(words.begin(), words.end());
+            string document;
+            for (const string_view word : words) {
+                document.append(word).push_back(' ');
+            }
+            corpus.documents.push_back(move(document));
+        } else {
+            corpus.documents.push_back(GenerateQuery(generator, dictionary, scenario.document_words));
+        }
+        corpus.ratings.push_back({static_cast<int>(generator() % 11) - 5, static_cast<int>(generator() % 11) - 5});
+    }
+    for (int i = 0; i < scenario.query_count; ++i) {
+        corpus.queries.push_back(GenerateQuery(generator, dictionary, scenario.query_words, scenario.minus_probability));
+    }
+    return corpus;
+}
+
+void Ingest(SearchServer& search_server, const Corpus& corpus) {
+    for (size_t id = 0; id < corpus.documents.size(); ++id) {
+        search_server.AddDocument(static_cast<int>(id), corpus.documents[id], DocumentStatus::ACTUAL, corpus.ratings[id]);
+    }
+}
+
+double ElapsedNs(chrono::steady_clock::time_point start_time) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start_time).count();
+}
+
+// body возвращает (время в нс, контрольная сумма); первый прогон — прогрев и в статистику не входит.
+Result Measure(const string& name, const Scenario& scenario, size_t operations, int repetitions,
+               const function<pair<double, double>()>& body) {
+    Result result;
+    result.name = name;
+    result.scenario = scenario;
+    result.operations = operations;
+    result.checksum = body().second;
+    vector<double> samples;
+    for (int i = 0; i < repetitions; ++i) {
+        samples.push_back(body().first / operations);
+    }
+    result.ns_per_op = Summarize(move(samples));
+    cerr << name << " docs="s << scenario.document_count << " dict="s << scenario.dictionary_size
+         << " qwords="s << scenario.query_words << " minus="s << scenario.minus_probability
+         << ": median "s << result.ns_per_op.median << " ns/op"s << endl;
+    return result;
+}
+
+template <typename ExecutionPolicy>
+pair<double, double> RunFindTopDocuments(const SearchServer& search_server, const vector<string>& queries,
+                                         ExecutionPolicy&& policy) {
+    double checksum = 0;
+    const auto start_time = chrono::steady_clock::now();
+    for (const string_view query : queries) {
+        for (const Document& document : search_server.FindTopDocuments(policy, query)) {
+            checksum += document.relevance;
+        }
+    }
+    return {ElapsedNs(start_time), checksum};
+}
+
+template <typename ExecutionPolicy>
+pair<double, double> RunMatchDocument(const SearchServer& search_server, const vector<string>& queries,
+                                      ExecutionPolicy&& policy) {
+    const int document_count = search_server.GetDocumentCount();
+    double checksum = 0;
+    const auto start_time = chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const auto [words, status] = search_server.MatchDocument(policy, queries[i], static_cast<int>(i % document_count));
+        checksum += words.size();
+    }
+    return {ElapsedNs(start_time), checksum};
+}
+
+template <typename ExecutionPolicy>
+pair<double, double> RunRemoveDocument(const Corpus& corpus, ExecutionPolicy&& policy) {
+    SearchServer search_server("and in on"s);
+    Ingest(search_server, corpus);
+    const auto start_time = chrono::steady_clock::now();
+    for (int id = 0; id < static_cast<int>(corpus.documents.size()); id += 10) {
+        search_server.RemoveDocument(policy, id);
+    }
+    return {ElapsedNs(start_time), static_cast<double>(search_server.GetDocumentCount())};
+}
+
+vector<Result> RunScenario(const Scenario& scenario, const Options& options) {
+    const Corpus corpus = GenerateCorpus(scenario, options.seed);
+    const size_t document_count = corpus.documents.size();
+    const size_t query_count = corpus.queries.size();
+    const size_t removed_count = (document_count + 9) / 10;
+    const int repetitions = options.repetitions;
+
+    vector<Result> results;
+    results.push_back(Measure("AddDocument"s, scenario, document_count, repetitions, [&] {
+        SearchServer search_server("and in on"s);
+        const auto start_time = chrono::steady_clock::now();
+        Ingest(search_server, corpus);
+        return pair{ElapsedNs(start_time), static_cast<double>(search_server.GetDocumentCount())};
+    }));
+
+    SearchServer search_server("and in on"s);
+    Ingest(search_server, corpus);
+    results.push_back(Measure("FindTopDocuments/seq"s, scenario, query_count, repetitions, [&] {
+        return RunFindTopDocuments(search_server, corpus.queries, execution::seq);
+    }));
+    results.push_back(Measure("FindTopDocuments/par"s, scenario, query_count, repetitions, [&] {
+        return RunFindTopDocuments(search_server, corpus.queries, execution::par);
+    }));
+    results.push_back(Measure("MatchDocument/seq"s, scenario, query_count, repetitions, [&] {
+        return RunMatchDocument(search_server, corpus.queries, execution::seq);
+    }));
+    results.push_back(Measure("MatchDocument/par"s, scenario, query_count, repetitions, [&] {
+        return RunMatchDocument(search_server, corpus.queries, execution::par);
+    }));
+    results.push_back(Measure("ProcessQueries"s, scenario, query_count, repetitions, [&] {
+        const auto start_time = chrono::steady_clock::now();
+        double checksum = 0;
+        for (const auto& documents : ProcessQueries(search_server, corpus.queries)) {
+            checksum += documents.size();
+        }
+        return pair{ElapsedNs(start_time), checksum};
+    }));
+    results.push_back(Measure("RemoveDocument/seq"s, scenario, removed_count, repetitions, [&] {
+        return RunRemoveDocument(corpus, execution::seq);
+    }));
+    results.push_back(Measure("RemoveDocument/par"s, scenario, removed_count, repetitions, [&] {
+        return RunRemoveDocument(corpus, execution::par);
+    }));
+    results.push_back(Measure("RemoveDuplicates"s, scenario, document_count, repetitions, [&] {
+        SearchServer deduplicated("and in on"s);
+        Ingest(deduplicated, corpus);
+        // RemoveDuplicates печатает каждый найденный дубликат — в отчёт это не нужно
+        ostringstream discarded;
+        streambuf* const cout_buffer = cout.rdbuf(discarded.rdbuf());
+        const auto start_time = chrono::steady_clock::now();
+        RemoveDuplicates(deduplicated);
+        const double elapsed = ElapsedNs(start_time);
+        cout.rdbuf(cout_buffer);
+        return pair{elapsed, static_cast<double>(deduplicated.GetDocumentCount())};
+    }));
+    return results;
+}
+
+void PrintJson(ostream& out, const Options& options, const vector<Result>& results) {
+    out << setprecision(10);
+    out << "{\n"s
+        << "  \"seed\": "s << options.seed << ",\n"s
+        << "  \"repetitions\": "s << options.repetitions << ",\n"s
+        << "  \"hardware_concurrency\": "s << thread::hardware_concurrency() << ",\n"s
+        << "  \"compiler\": \""s << __VERSION__ << "\",\n"s
+#ifdef NDEBUG
+        << "  \"assertions\": false,\n"s
+#else
+        << "  \"assertions\": true,\n"s
+#endif
+        << "  \"results\": ["s;
+    bool is_first = true;
+    for (const Result& result : results) {
+        const Scenario& scenario = result.scenario;
+        const Summary& summary = result.ns_per_op;
+        out << (is_first ? "\n"s : ",\n"s)
+            << "    {\"name\": \""s << result.name << "\""s
+            << ", \"documents\": "s << scenario.document_count
+            << ", \"dictionary_size\": "s << scenario.dictionary_size
+            << ", \"document_words\": "s << scenario.document_words
+            << ", \"query_words\": "s << scenario.query_words
+            << ", \"minus_probability\": "s << scenario.minus_probability
+            << ", \"queries\": "s << scenario.query_count
+            << ", \"operations\": "s << result.operations
+            << ", \"ns_per_op\": {\"median\": "s << summary.median
+            << ", \"mean\": "s << summary.mean
+            << ", \"stddev\": "s << summary.stddev
+            << ", \"min\": "s << summary.min
+            << ", \"max\": "s << summary.max
+            << ", \"ci95\": "s << summary.ci95 << "}"s
+            << ", \"checksum\": "s << result.checksum << "}"s;
+        is_first = false;
+    }
+    out << "\n  ]\n}\n"s;
+}
+
+// Значения вне [min_value, max_value] отвергаются: нулевое число документов
+// или запросов привело бы к делению на ноль при замере.
+template <typename T>
+vector<T> ParseList(const string& value, T min_value, T max_value = numeric_limits<T>::max()) {
+    vector<T> values;
+    istringstream input(value);
+    string item;
+    while (getline(input, item, ',')) {
+        istringstream item_input(item);
+        T parsed;
+        if (!(item_input >> parsed) || !(item_input >> ws).eof() || parsed < min_value || parsed > max_value) {
+            throw invalid_argument("Invalid list item "s + item);
+        }
+        values.push_back(parsed);
+    }
+    if (values.empty()) {
+        throw invalid_argument("Empty list"s);
+    }
+    return values;
+}
+
+int ParseCount(const string& value) {
+    const vector<int> values = ParseList<int>(value, 1);
+    if (values.size() != 1) {
+        throw invalid_argument("Expected a single number, got "s + value);
+    }
+    return values.front();
+}
+
+void PrintUsage() {
+    cerr << "Usage: search_benchmark [--documents N,N...] [--dictionary-size N,N...]\n"
+            "                        [--query-words N,N...] [--minus-probability P,P...]\n"
+            "                        [--document-words N] [--queries N] [--repetitions N]\n"
+            "                        [--seed N] [--output FILE]\n"
+            "Runs every combination of the listed parameters and writes JSON\n"
+            "to FILE or stdout; progress goes to stderr.\n"s;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const string arg = argv[i];
+            if (i + 1 >= argc) {
+                PrintUsage();
+                return 1;
+            }
+            const string value = argv[++i];
+            if (arg == "--documents"s) {
+                options.document_counts = ParseList<int>(value, 1);
+            } else if (arg == "--dictionary-size"s) {
+                options.dictionary_sizes = ParseList<int>(value, 1);
+            } else if (arg == "--query-words"s) {
+                options.query_words = ParseList<int>(value, 1);
+            } else if (arg == "--minus-probability"s) {
+                options.minus_probabilities = ParseList<double>(value, 0.0, 1.0);
+            } else if (arg == "--document-words"s) {
+                options.document_words = ParseCount(value);
+            } else if (arg == "--queries"s) {
+                options.query_count = ParseCount(value);
+            } else if (arg == "--repetitions"s) {
+                options.repetitions = ParseCount(value);
+            } else if (arg == "--seed"s) {
+                options.seed = stoul(value);
+            } else if (arg == "--output"s) {
+                options.output = value;
+            } else {
+                PrintUsage();
+                return 1;
+            }
+        }
+
+        vector<Result> results;
+        for (const int document_count : options.document_counts) {
+            for (const int dictionary_size : options.dictionary_sizes) {
+                for (const int query_words : options.query_words) {
+                    for (const double minus_probability : options.minus_probabilities) {
+                        Scenario scenario;
+                        scenario.document_count = document_count;
+                        scenario.dictionary_size = dictionary_size;
+                        scenario.document_words = options.document_words;
+                        scenario.query_words = query_words;
+                        scenario.minus_probability = minus_probability;
+                        scenario.query_count = options.query_count;
+                        for (Result& result : RunScenario(scenario, options)) {
+                            results.push_back(move(result));
+                        }
+                    }
+                }
+            }
+        }
+
+        if (options.output.empty()) {
+            PrintJson(cout, options, results);
+        } else {
+            ofstream out(options.output);
+            PrintJson(out, options, results);
+            if (!out) {
+                throw runtime_error("Cannot write "s + options.output);
+            }
+        }
+    } catch (const exception& e) {
+        cerr << "search_benchmark: "s << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
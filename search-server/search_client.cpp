@@ -0,0 +1,164 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "search_client.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+[[noreturn]] void ThrowSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+int ConnectUnix(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Unix socket path is too long"s);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ThrowSystemError("socket"s);
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        const int error = errno;
+        close(fd);
+        errno = error;
+        ThrowSystemError("connect "s + path);
+    }
+    return fd;
+}
+
+int ConnectTcp(const std::string& host, uint16_t port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        throw std::invalid_argument("Invalid IPv4 address "s + host);
+    }
+
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ThrowSystemError("socket"s);
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        const int error = errno;
+        close(fd);
+        errno = error;
+        ThrowSystemError("connect "s + host + ":"s + std::to_string(port));
+    }
+    const int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    return fd;
+}
+
+}  // namespace
+
+SearchClient::SearchClient(const std::string& endpoint) {
+    const std::string unix_prefix = "unix:"s;
+    if (endpoint.compare(0, unix_prefix.size(), unix_prefix) == 0) {
+        fd_ = ConnectUnix(endpoint.substr(unix_prefix.size()));
+        return;
+    }
+    const size_t colon = endpoint.rfind(':');
+    if (colon == std::string::npos) {
+        throw std::invalid_argument("Endpoint must be host:port or unix:path"s);
+    }
+    const int port = std::stoi(endpoint.substr(colon + 1));
+    if (port <= 0 || port > 65535) {
+        throw std::invalid_argument("Invalid port in "s + endpoint);
+    }
+    fd_ = ConnectTcp(endpoint.substr(0, colon), static_cast<uint16_t>(port));
+}
+
+SearchClient::~SearchClient() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+SearchClient::SearchClient(SearchClient&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1))
+    , input_(std::move(other.input_))
+    , input_offset_(std::exchange(other.input_offset_, 0))
+    , output_(std::move(other.output_)) {
+}
+
+SearchClient& SearchClient::operator=(SearchClient&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        fd_ = std::exchange(other.fd_, -1);
+        input_ = std::move(other.input_);
+        input_offset_ = std::exchange(other.input_offset_, 0);
+        output_ = std::move(other.output_);
+    }
+    return *this;
+}
+
+void SearchClient::Send(const Request& request) {
+    output_.clear();
+    AppendRequestFrame(output_, request);
+    size_t offset = 0;
+    while (offset < output_.size()) {
+        const ssize_t size = send(fd_, output_.data() + offset, output_.size() - offset, MSG_NOSIGNAL);
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("send"s);
+        }
+        offset += static_cast<size_t>(size);
+    }
+}
+
+Response SearchClient::Receive() {
+    char buffer[64 * 1024];
+    while (true) {
+        const std::string_view input = std::string_view(input_).substr(input_offset_);
+        if (const auto frame_size = GetFrameSize(input)) {
+            Response response = ParseResponseFrame(input.substr(0, *frame_size));
+            input_offset_ += *frame_size;
+            if (input_offset_ == input_.size()) {
+                input_.clear();
+                input_offset_ = 0;
+            }
+            return response;
+        }
+        if (input_offset_ > 0) {
+            input_.erase(0, input_offset_);
+            input_offset_ = 0;
+        }
+
+        const ssize_t size = recv(fd_, buffer, sizeof(buffer), 0);
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("recv"s);
+        }
+        if (size == 0) {
+            throw std::runtime_error("Connection closed by server"s);
+        }
+        input_.append(buffer, static_cast<size_t>(size));
+    }
+}
+
+Response SearchClient::Call(const Request& request) {
+    Send(request);
+    return Receive();
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "server_protocol.h"
+
+// Блокирующий клиент протокола SearchDaemon.
+// Адрес задаётся как "host:port" или "unix:/path/to/socket".
+// Send/Receive позволяют держать несколько запросов в полёте на одном соединении.
+class SearchClient {
+public:
+    explicit SearchClient(const std::string& endpoint);
+    ~SearchClient();
+
+    SearchClient(SearchClient&& other) noexcept;
+    SearchClient& operator=(SearchClient&& other) noexcept;
+    SearchClient(const SearchClient&) = delete;
+    SearchClient& operator=(const SearchClient&) = delete;
+
+    void Send(const Request& request);
+    Response Receive();
+    Response Call(const Request& request);
+
+private:
+    int fd_ = -1;
+    std::string input_;
+    size_t input_offset_ = 0;
+    std::string output_;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "document.h"
+
+enum class QueryStatus {
+    OK,
+    TRUNCATED,  // дедлайн наступил, документы — лучшие из уже просмотренных
+    TIMEOUT,    // дедлайн наступил до первого найденного документа
+    CANCELLED,
+};
+
+struct SearchResult {
+    std::vector<Document> documents;
+    QueryStatus status = QueryStatus::OK;
+};
+
+// Копии токена разделяют один флаг: отмена через любую копию видна всем.
+class CancellationToken {
+public:
+    void Cancel() const {
+        cancelled_->store(true, std::memory_order_relaxed);
+    }
+    bool IsCancelled() const {
+        return cancelled_->load(std::memory_order_relaxed);
+    }
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_ = std::make_shared<std::atomic<bool>>(false);
+};
+
+struct SearchControl {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point deadline = Clock::time_point::max();
+    CancellationToken cancellation;
+};
+
+// Проверяет дедлайн и отмену между блоками постингов в FindAllDocuments.
+class QueryGuard {
+public:
+    static constexpr size_t POSTING_BLOCK_SIZE = 1024;
+
+    explicit QueryGuard(const SearchControl& control) : control_(control) {}
+
+    bool ShouldStop() {
+        if (status_ == QueryStatus::OK) {
+            if (control_.cancellation.IsCancelled()) {
+                status_ = QueryStatus::CANCELLED;
+            } else if (SearchControl::Clock::now() >= control_.deadline) {
+                status_ = QueryStatus::TIMEOUT;
+            }
+        }
+        return IsStopped();
+    }
+
+    bool IsStopped() const {
+        return status_ != QueryStatus::OK;
+    }
+
+    SearchResult MakeResult(std::vector<Document> documents) const {
+        if (status_ == QueryStatus::CANCELLED) {
+            return {{}, QueryStatus::CANCELLED};
+        }
+        if (status_ == QueryStatus::TIMEOUT && !documents.empty()) {
+            return {std::move(documents), QueryStatus::TRUNCATED};
+        }
+        return {std::move(documents), status_};
+    }
+
+private:
+    const SearchControl& control_;
+    QueryStatus status_ = QueryStatus::OK;
+};
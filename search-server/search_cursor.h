@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+
+#include "document.h"
+
+// Позиция в выдаче: последний отданный документ. Следующая страница
+// начинается строго после него в порядке (relevance ↓, rating ↓, id ↑),
+// где relevance округлена до шага EPSILON.
+// Курсор по умолчанию указывает на начало выдачи.
+class SearchCursor {
+public:
+    SearchCursor() = default;
+
+    bool IsEnd() const {
+        return is_end_;
+    }
+
+private:
+    friend class SearchServer;
+
+    double relevance_ = 0.0;
+    int rating_ = 0;
+    int id_ = 0;
+    bool is_started_ = false;
+    bool is_end_ = false;
+};
+
+struct SearchPage {
+    std::vector<Document> documents;
+    SearchCursor next;
+};
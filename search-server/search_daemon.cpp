@@ -0,0 +1,526 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "search_daemon.h"
+
+namespace {
+
+constexpr int MAX_EPOLL_EVENTS = 64;
+constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+// Пределы на соединение, после которых чтение приостанавливается.
+constexpr size_t MAX_IN_FLIGHT_REQUESTS = 128;
+constexpr size_t MAX_PENDING_OUTPUT_SIZE = 4 * 1024 * 1024;
+constexpr auto ACCEPT_BACKOFF = std::chrono::milliseconds(100);
+
+[[noreturn]] void ThrowSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+uint32_t PeekRequestId(std::string_view frame) {
+    uint32_t request_id = 0;
+    for (size_t i = FRAME_HEADER_SIZE; i < std::min(frame.size(), FRAME_HEADER_SIZE + 4); ++i) {
+        request_id = (request_id << 8) | static_cast<uint8_t>(frame[i]);
+    }
+    return request_id;
+}
+
+}  // namespace
+
+SearchDaemon::SearchDaemon(SearchServer& search_server, size_t worker_count)
+    : search_server_(search_server) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        ThrowSystemError("epoll_create1"s);
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        ThrowSystemError("eventfd"s);
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) < 0) {
+        ThrowSystemError("epoll_ctl"s);
+    }
+
+    worker_count = std::max<size_t>(worker_count, 1);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+SearchDaemon::~SearchDaemon() {
+    {
+        std::lock_guard lock(tasks_mutex_);
+        workers_stopping_ = true;
+    }
+    tasks_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+
+    for (auto& [fd, _] : connections_) {
+        close(fd);
+    }
+    for (const int fd : listen_fds_) {
+        close(fd);
+    }
+    for (const std::string& path : unix_paths_) {
+        unlink(path.c_str());
+    }
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+uint16_t SearchDaemon::ListenTcp(const std::string& host, uint16_t port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        throw std::invalid_argument("Invalid IPv4 address "s + host);
+    }
+
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ThrowSystemError("socket"s);
+    }
+    const int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || listen(fd, SOMAXCONN) < 0) {
+        const int error = errno;
+        close(fd);
+        errno = error;
+        ThrowSystemError("bind "s + host + ":"s + std::to_string(port));
+    }
+
+    socklen_t length = sizeof(address);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    AddListener(fd);
+    return ntohs(address.sin_port);
+}
+
+void SearchDaemon::ListenUnix(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Unix socket path is too long"s);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ThrowSystemError("socket"s);
+    }
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || listen(fd, SOMAXCONN) < 0) {
+        const int error = errno;
+        close(fd);
+        errno = error;
+        ThrowSystemError("bind "s + path);
+    }
+    unix_paths_.push_back(path);
+    AddListener(fd);
+}
+
+void SearchDaemon::Run() {
+    epoll_event events[MAX_EPOLL_EVENTS];
+    while (!stopping_) {
+        const int event_count = epoll_wait(epoll_fd_, events, MAX_EPOLL_EVENTS, GetEpollTimeout());
+        if (event_count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("epoll_wait"s);
+        }
+        if (accept_paused_ && std::chrono::steady_clock::now() >= accept_resume_time_) {
+            ResumeAccept();
+        }
+
+        for (int i = 0; i < event_count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                uint64_t counter;
+                while (read(wake_fd_, &counter, sizeof(counter)) > 0) {
+                }
+                FlushReadyConnections();
+                continue;
+            }
+            if (std::find(listen_fds_.begin(), listen_fds_.end(), fd) != listen_fds_.end()) {
+                Accept(fd);
+                continue;
+            }
+
+            const auto it = connections_.find(fd);
+            if (it == connections_.end()) {
+                continue;
+            }
+            const auto connection = it->second;
+            if (events[i].events & EPOLLIN) {
+                ReadFrom(connection);
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                Close(connection);
+            }
+            if (!connection->closed && (events[i].events & EPOLLOUT)) {
+                WriteTo(connection);
+            }
+            Resume(connection);
+        }
+    }
+}
+
+void SearchDaemon::Stop() {
+    stopping_ = true;
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto written = write(wake_fd_, &one, sizeof(one));
+}
+
+Response SearchDaemon::Execute(const Request& request) {
+    Response response;
+    response.request_id = request.request_id;
+    response.type = request.type;
+    try {
+        switch (request.type) {
+            case RequestType::FIND_TOP_DOCUMENTS: {
+                std::shared_lock lock(index_mutex_);
+                response.documents = search_server_.FindTopDocuments(request.text, request.status);
+                break;
+            }
+            case RequestType::MATCH_DOCUMENT: {
+                std::shared_lock lock(index_mutex_);
+                const auto [words, status] = search_server_.MatchDocument(request.text, request.document_id);
+                response.matched_words.assign(words.begin(), words.end());
+                response.document_status = status;
+                break;
+            }
+            case RequestType::ADD_DOCUMENT: {
+                std::unique_lock lock(index_mutex_);
+                search_server_.AddDocument(request.document_id, request.text, request.status, request.ratings);
+                break;
+            }
+            case RequestType::REMOVE_DOCUMENT: {
+                std::unique_lock lock(index_mutex_);
+                search_server_.RemoveDocument(request.document_id);
+                break;
+            }
+            case RequestType::GET_CORPUS_STATISTICS: {
+                std::shared_lock lock(index_mutex_);
+                response.statistics = search_server_.GetCorpusStatistics(request.text);
+                break;
+            }
+            case RequestType::FIND_TOP_DOCUMENTS_GLOBAL: {
+                std::shared_lock lock(index_mutex_);
+                response.documents = search_server_.FindTopDocuments(request.statistics, request.text, request.status);
+                break;
+            }
+        }
+    } catch (const std::invalid_argument& e) {
+        response.status = ResponseStatus::INVALID_ARGUMENT;
+        response.error = e.what();
+    } catch (const std::out_of_range& e) {
+        response.status = ResponseStatus::OUT_OF_RANGE;
+        response.error = e.what();
+    } catch (const std::exception& e) {
+        // bad_alloc и прочее не должны уронить рабочий поток, а с ним и демон
+        response.status = ResponseStatus::INTERNAL_ERROR;
+        response.error = e.what();
+    } catch (...) {
+        response.status = ResponseStatus::INTERNAL_ERROR;
+        response.error = "Unknown error"s;
+    }
+    return response;
+}
+
+void SearchDaemon::AddListener(int fd) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+        close(fd);
+        ThrowSystemError("epoll_ctl"s);
+    }
+    listen_fds_.push_back(fd);
+}
+
+void SearchDaemon::Accept(int listen_fd) {
+    while (true) {
+        const int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                // EMFILE, ENFILE, ENOBUFS: соединение остаётся в очереди, и без паузы
+                // level-triggered epoll будет будить цикл снова и снова
+                PauseAccept();
+            }
+            return;
+        }
+        const int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+        auto connection = std::make_shared<Connection>();
+        connection->fd = fd;
+        connection->events = EPOLLIN;
+        connections_[fd] = std::move(connection);
+    }
+}
+
+void SearchDaemon::PauseAccept() {
+    accept_resume_time_ = std::chrono::steady_clock::now() + ACCEPT_BACKOFF;
+    if (accept_paused_) {
+        return;
+    }
+    accept_paused_ = true;
+    for (const int fd : listen_fds_) {
+        epoll_event event{};
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+    }
+}
+
+void SearchDaemon::ResumeAccept() {
+    accept_paused_ = false;
+    for (const int fd : listen_fds_) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+    }
+}
+
+int SearchDaemon::GetEpollTimeout() const {
+    if (!accept_paused_) {
+        return -1;
+    }
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(accept_resume_time_ - std::chrono::steady_clock::now());
+    return static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0));
+}
+
+void SearchDaemon::ReadFrom(const std::shared_ptr<Connection>& connection) {
+    char buffer[READ_CHUNK_SIZE];
+    while (!connection->closed && !connection->read_closed && !IsReadPaused(*connection)) {
+        const ssize_t size = read(connection->fd, buffer, sizeof(buffer));
+        if (size > 0) {
+            connection->input.append(buffer, static_cast<size_t>(size));
+            ParseFrames(connection);
+            continue;
+        }
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (size == 0) {
+            // полученные кадры ещё обрабатываются, соединение закроет Resume
+            connection->read_closed = true;
+            break;
+        }
+        Close(connection);
+        return;
+    }
+}
+
+void SearchDaemon::ParseFrames(const std::shared_ptr<Connection>& connection) {
+    const std::string_view input = connection->input;
+    size_t offset = 0;
+    // кадры сверх лимита остаются в input до Resume
+    while (!IsReadPaused(*connection)) {
+        std::optional<size_t> frame_size;
+        try {
+            frame_size = GetFrameSize(input.substr(offset));
+        } catch (const std::length_error&) {
+            Close(connection);
+            return;
+        }
+        if (!frame_size) {
+            break;
+        }
+        const std::string_view frame = input.substr(offset, *frame_size);
+        offset += *frame_size;
+
+        ++connection->in_flight;
+        try {
+            Submit([this, connection, request = ParseRequestFrame(frame)] {
+                Complete(connection, Execute(request));
+            });
+        } catch (const std::invalid_argument& e) {
+            Response response;
+            response.request_id = PeekRequestId(frame);
+            response.status = ResponseStatus::BAD_REQUEST;
+            response.error = e.what();
+            Complete(connection, response);
+        }
+    }
+    connection->input.erase(0, offset);
+}
+
+void SearchDaemon::WriteTo(const std::shared_ptr<Connection>& connection) {
+    while (connection->output_offset < connection->output.size()) {
+        const ssize_t size = send(connection->fd,
+                                  connection->output.data() + connection->output_offset,
+                                  connection->output.size() - connection->output_offset,
+                                  MSG_NOSIGNAL);
+        if (size >= 0) {
+            connection->output_offset += static_cast<size_t>(size);
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (connection->output_offset > connection->output.size() / 2) {
+                connection->output.erase(0, connection->output_offset);
+                connection->output_offset = 0;
+            }
+            return;
+        }
+        Close(connection);
+        return;
+    }
+    connection->output.clear();
+    connection->output_offset = 0;
+}
+
+void SearchDaemon::FlushReadyConnections() {
+    std::vector<std::shared_ptr<Connection>> ready;
+    {
+        std::lock_guard lock(ready_mutex_);
+        ready.swap(ready_connections_);
+    }
+    for (const auto& connection : ready) {
+        if (connection->closed) {
+            continue;
+        }
+        {
+            std::lock_guard lock(connection->completed_mutex);
+            connection->output.append(connection->completed);
+            connection->completed.clear();
+            connection->in_flight -= connection->completed_count;
+            connection->completed_count = 0;
+        }
+        if (!(connection->events & EPOLLOUT)) {
+            WriteTo(connection);
+        }
+        Resume(connection);
+    }
+}
+
+void SearchDaemon::Resume(const std::shared_ptr<Connection>& connection) {
+    if (connection->closed) {
+        return;
+    }
+    // после снятия паузы разбираем кадры, уже лежащие в input
+    ParseFrames(connection);
+    if (connection->closed) {
+        return;
+    }
+    // незавершённый кадр после EOF уже не дочитать
+    if (connection->read_closed && connection->in_flight == 0
+        && connection->output_offset == connection->output.size()) {
+        Close(connection);
+        return;
+    }
+    UpdateInterest(*connection);
+}
+
+void SearchDaemon::Close(const std::shared_ptr<Connection>& connection) {
+    if (connection->closed) {
+        return;
+    }
+    connection->closed = true;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection->fd, nullptr);
+    close(connection->fd);
+    connections_.erase(connection->fd);
+    // освободился дескриптор — можно снова принимать соединения
+    if (accept_paused_) {
+        ResumeAccept();
+    }
+}
+
+void SearchDaemon::UpdateInterest(Connection& connection) {
+    uint32_t events = 0;
+    if (!connection.read_closed && !IsReadPaused(connection)) {
+        events |= EPOLLIN;
+    }
+    if (connection.output_offset < connection.output.size()) {
+        events |= EPOLLOUT;
+    }
+    if (connection.events == events) {
+        return;
+    }
+    connection.events = events;
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = connection.fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+bool SearchDaemon::IsReadPaused(const Connection& connection) {
+    return connection.in_flight >= MAX_IN_FLIGHT_REQUESTS
+        || connection.output.size() - connection.output_offset >= MAX_PENDING_OUTPUT_SIZE;
+}
+
+void SearchDaemon::Submit(std::function<void()> task) {
+    {
+        std::lock_guard lock(tasks_mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    tasks_cv_.notify_one();
+}
+
+void SearchDaemon::Complete(const std::shared_ptr<Connection>& connection, const Response& response) {
+    bool was_empty;
+    {
+        std::lock_guard lock(connection->completed_mutex);
+        was_empty = connection->completed.empty();
+        AppendResponseFrame(connection->completed, response);
+        ++connection->completed_count;
+    }
+    if (!was_empty) {
+        return;
+    }
+    {
+        std::lock_guard lock(ready_mutex_);
+        ready_connections_.push_back(connection);
+    }
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto written = write(wake_fd_, &one, sizeof(one));
+}
+
+void SearchDaemon::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(tasks_mutex_);
+            tasks_cv_.wait(lock, [this] { return workers_stopping_ || !tasks_.empty(); });
+            if (workers_stopping_) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
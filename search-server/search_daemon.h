@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "search_server.h"
+#include "server_protocol.h"
+
+// Сетевая обёртка над SearchServer: цикл epoll на TCP и Unix-сокетах,
+// конвейерная обработка кадров из server_protocol.h и пул рабочих потоков.
+// Поиск и MatchDocument выполняются параллельно под разделяемой блокировкой,
+// AddDocument и RemoveDocument — под эксклюзивной.
+// Ответы одного соединения могут приходить не в порядке запросов,
+// клиент сопоставляет их по request_id.
+// Пока у соединения слишком много запросов в работе или неотправленных ответов,
+// демон перестаёт читать из него (EPOLLIN снимается) — клиент упирается в TCP-окно.
+class SearchDaemon {
+public:
+    SearchDaemon(SearchServer& search_server, size_t worker_count);
+    ~SearchDaemon();
+
+    SearchDaemon(const SearchDaemon&) = delete;
+    SearchDaemon& operator=(const SearchDaemon&) = delete;
+
+    // Возвращает фактический порт (полезно при port == 0).
+    uint16_t ListenTcp(const std::string& host, uint16_t port);
+    void ListenUnix(const std::string& path);
+
+    // Блокирует вызывающий поток до Stop().
+    void Run();
+    // Можно вызывать из другого потока и из обработчика сигнала.
+    void Stop();
+
+    Response Execute(const Request& request);
+
+private:
+    struct Connection {
+        int fd = -1;
+        bool closed = false;
+        bool read_closed = false;  // клиент закрыл свою сторону, ответы ещё досылаются
+        uint32_t events = 0;  // текущая подписка в epoll
+        size_t in_flight = 0;  // запросы, ответы на которые ещё не попали в output
+        std::string input;
+        std::string output;
+        size_t output_offset = 0;
+        std::mutex completed_mutex;
+        std::string completed;
+        size_t completed_count = 0;
+    };
+
+    SearchServer& search_server_;
+    std::shared_mutex index_mutex_;
+
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::vector<int> listen_fds_;
+    std::vector<std::string> unix_paths_;
+    // accept4 упёрся в лимит дескрипторов или памяти: слушающие сокеты сняты
+    // с epoll до accept_resume_time_ или до закрытия любого соединения
+    bool accept_paused_ = false;
+    std::chrono::steady_clock::time_point accept_resume_time_;
+    std::unordered_map<int, std::shared_ptr<Connection>> connections_;
+    std::atomic<bool> stopping_ = false;
+
+    std::mutex ready_mutex_;
+    std::vector<std::shared_ptr<Connection>> ready_connections_;
+
+    std::mutex tasks_mutex_;
+    std::condition_variable tasks_cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool workers_stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    void AddListener(int fd);
+    void Accept(int listen_fd);
+    void PauseAccept();
+    void ResumeAccept();
+    int GetEpollTimeout() const;
+    void ReadFrom(const std::shared_ptr<Connection>& connection);
+    void ParseFrames(const std::shared_ptr<Connection>& connection);
+    void WriteTo(const std::shared_ptr<Connection>& connection);
+    void FlushReadyConnections();
+    void Resume(const std::shared_ptr<Connection>& connection);
+    void Close(const std::shared_ptr<Connection>& connection);
+    void UpdateInterest(Connection& connection);
+    static bool IsReadPaused(const Connection& connection);
+
+    void Submit(std::function<void()> task);
+    void Complete(const std::shared_ptr<Connection>& connection, const Response& response);
+    void WorkerLoop();
+};
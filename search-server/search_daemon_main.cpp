@@ -0,0 +1,107 @@
+#include "search_daemon.h"
+#include "query_generator.h"
+
+#include <csignal>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+ 
+using namespace std;
+ 
+namespace {
+ 
+SearchDaemon* daemon_to_stop = nullptr;
+ 
+void HandleStopSignal(int) {
+    if (daemon_to_stop != nullptr) {
+        daemon_to_stop->Stop();
+    }
+}
+ 
+void PrintUsage() {
+    cerr << "Usage: search_daemon [--tcp HOST:PORT] [--unix PATH] [--workers N]\n"
+            "                     [--stop-words \"WORDS\"] [--generate-documents N]\n"
+            "                     [--dictionary-size N] [--seed N]\n"s;
+}
+ 
+}  // namespace
+ 
+int main(int argc, char* argv[]) {
+    string tcp_endpoint;
+    string unix_path;
+    size_t worker_count = max(1u, thread::hardware_concurrency());
+    string stop_words;
+    int document_count = 0;
+    int dictionary_size = 1000;
+    unsigned seed = mt19937::default_seed;
+ 
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+        const string value = argv[++i];
+        if (arg == "--tcp"s) {
+            tcp_endpoint = value;
+        } else if (arg == "--unix"s) {
+            unix_path = value;
+        } else if (arg == "--workers"s) {
+            worker_count = stoul(value);
+        } else if (arg == "--stop-words"s) {
+            stop_words = value;
+        } else if (arg == "--generate-documents"s) {
+            document_count = stoi(value);
+        } else if (arg == "--dictionary-size"s) {
+            dictionary_size = stoi(value);
+        } else if (arg == "--seed"s) {
+            seed = stoul(value);
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (tcp_endpoint.empty() && unix_path.empty()) {
+        tcp_endpoint = "127.0.0.1:7777"s;
+    }
+ 
+    try {
+        SearchServer search_server(stop_words);
+        if (document_count > 0) {
+            mt19937 generator(seed);
+            const auto dictionary = GenerateDictionary(generator, dictionary_size, 10);
+            const auto documents = GenerateQueries(generator, dictionary, document_count, 70);
+            for (int id = 0; id < document_count; ++id) {
+                search_server.AddDocument(id, documents[id], DocumentStatus::ACTUAL, {1, 2, 3});
+            }
+        }
+ 
+        SearchDaemon daemon(search_server, worker_count);
+        if (!tcp_endpoint.empty()) {
+            const size_t colon = tcp_endpoint.rfind(':');
+            if (colon == string::npos) {
+                PrintUsage();
+                return 1;
+            }
+            const uint16_t port = daemon.ListenTcp(tcp_endpoint.substr(0, colon),
+                                                   static_cast<uint16_t>(stoi(tcp_endpoint.substr(colon + 1))));
+            cerr << "Listening on "s << tcp_endpoint.substr(0, colon) << ":"s << port << endl;
+        }
+        if (!unix_path.empty()) {
+            daemon.ListenUnix(unix_path);
+            cerr << "Listening on unix:"s << unix_path << endl;
+        }
+        cerr << search_server.GetDocumentCount() << " documents, "s << worker_count << " workers"s << endl;
+ 
+        daemon_to_stop = &daemon;
+        signal(SIGINT, HandleStopSignal);
+        signal(SIGTERM, HandleStopSignal);
+        daemon.Run();
+        daemon_to_stop = nullptr;
+    } catch (const exception& e) {
+        cerr << "search_daemon: "s << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,42 +1,373 @@
 #include <numeric>
 #include "search_server.h"
  
+// Ключи индексов — string_view на слова словаря, поэтому контейнеры не копируются
+// целиком: ключи перепривязываются к словам нового словаря, а вложенные
+// контейнеры создаются с аллокаторами новых счётчиков.
+SearchServer::SearchServer(const SearchServer& other)
+    : stop_words_(std::set<std::string, std::less<>>(other.stop_words_.begin(), other.stop_words_.end()),
+                  *allocation_counters_)
+    , free_term_ids_(other.free_term_ids_.begin(), other.free_term_ids_.end(), *allocation_counters_)
+    , document_ids_(other.document_ids_.begin(), other.document_ids_.end(), *allocation_counters_)
+    , forward_index_mode_(other.forward_index_mode_)
+    , impact_index_enabled_(other.impact_index_enabled_) {
+    term_words_.resize(other.term_words_.size());
+    for (const auto& [word, term_id] : other.words_) {
+        const auto entry = words_.emplace_hint(words_.end(), word, term_id);
+        term_words_[term_id] = entry->first;
+    }
+    RebuildTermFilter();
+    
+    for (const auto& [word, document_freqs] : other.word_to_document_freqs_) {
+        word_to_document_freqs_.emplace_hint(word_to_document_freqs_.end(),
+                                             words_.find(word)->first,
+                                             DocumentFreqs(document_freqs.begin(), document_freqs.end(), *allocation_counters_));
+    }
+    for (const auto& [document_id, document_data] : other.documents_) {
+        documents_.emplace_hint(documents_.end(),
+                                document_id,
+                                DocumentData{document_data.rating,
+                                             document_data.status,
+                                             ForwardEntries(document_data.words.begin(), document_data.words.end(), *allocation_counters_)});
+    }
+    for (const auto& [word, impact_postings] : other.word_to_impact_postings_) {
+        word_to_impact_postings_.emplace_hint(word_to_impact_postings_.end(),
+                                              words_.find(word)->first,
+                                              ImpactPostings(impact_postings.begin(), impact_postings.end(), *allocation_counters_));
+    }
+}
+
+SearchServer& SearchServer::operator=(SearchServer other) noexcept {
+    Swap(other);
+    return *this;
+}
+
+// Аллокаторы обмениваются вместе с содержимым, а счётчики — вместе с аллокаторами.
+void SearchServer::Swap(SearchServer& other) noexcept {
+    std::swap(allocation_counters_, other.allocation_counters_);
+    std::swap(stop_words_, other.stop_words_);
+    words_.swap(other.words_);
+    term_words_.swap(other.term_words_);
+    free_term_ids_.swap(other.free_term_ids_);
+    std::swap(term_filter_, other.term_filter_);
+    std::swap(removed_term_count_, other.removed_term_count_);
+    word_to_document_freqs_.swap(other.word_to_document_freqs_);
+    documents_.swap(other.documents_);
+    document_ids_.swap(other.document_ids_);
+    std::swap(forward_index_mode_, other.forward_index_mode_);
+    std::swap(impact_index_enabled_, other.impact_index_enabled_);
+    word_to_impact_postings_.swap(other.word_to_impact_postings_);
+}
+
 void SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status,const std::vector<int>& ratings){
     if ((document_id < 0) || (documents_.count(document_id) > 0)) {
         throw std::invalid_argument("Invalid document_id"s);
     }
     
-    auto [doc_id_, doc_data_] = documents_.emplace(document_id, DocumentData{std::string(document), 
-                                                                ComputeAverageRating(ratings), 
-                                                                status
+    // разбор до вставки: невалидное слово не должно оставить документ без индекса
+    const auto words = SplitIntoWordsNoStop(document);
+    
+    auto [doc_id_, doc_data_] = documents_.emplace(document_id, DocumentData{ComputeAverageRating(ratings), 
+                                                                status,
+                                                                ForwardEntries(*allocation_counters_)
                                                                 });
     document_ids_.insert(document_id);
     
-    const auto words = SplitIntoWordsNoStop(doc_id_->second.data_string_);
- 
+    IndexWords(document_id, doc_id_->second, words);
+}
+
+void SearchServer::AddDocument(int document_id, const std::vector<std::string_view>& words, DocumentStatus status, const std::vector<int>& ratings) {
+    if ((document_id < 0) || (documents_.count(document_id) > 0)) {
+        throw std::invalid_argument("Invalid document_id"s);
+    }
+    
+    // слова проверяются так же, как при разборе текста: список мог собрать не TokenizeDocument
+    std::vector<std::string_view> document_words;
+    document_words.reserve(words.size());
+    for (const std::string_view word : words) {
+        if (word.empty() || word.find(' ') != std::string_view::npos || !IsValidWord(word)) {
+            throw std::invalid_argument("Word "s + std::string(word) + " is invalid"s);
+        }
+        if (!IsStopWord(word)) {
+            document_words.push_back(word);
+        }
+    }
+    
+    auto [doc_id_, doc_data_] = documents_.emplace(document_id, DocumentData{ComputeAverageRating(ratings), 
+                                                                status,
+                                                                ForwardEntries(*allocation_counters_)
+                                                                });
+    document_ids_.insert(document_id);
+    
+    IndexWords(document_id, doc_id_->second, document_words);
+}
+
+std::vector<std::string_view> SearchServer::TokenizeDocument(std::string_view document) const {
+    return SplitIntoWordsNoStop(document);
+}
+
+void SearchServer::IndexWords(int document_id, DocumentData& document_data, const std::vector<std::string_view>& words) {
     const double inv_word_count = 1.0 / words.size();
+    std::vector<uint32_t> term_ids;
+    if (forward_index_mode_ == ForwardIndexMode::COMPACT) {
+        term_ids.reserve(words.size());
+    }
     
     for (auto word : words) {
-        ids_of_docs_to_word_freqs_[document_id][word] += inv_word_count;
-        word_to_document_freqs_[word][document_id] += inv_word_count;
+        const uint32_t term_id = AddTerm(word);
+        // ключи индекса ссылаются на словарь, а не на текст документа,
+        // чтобы пережить RemoveDocument этого документа
+        auto& document_freqs = word_to_document_freqs_.try_emplace(term_words_[term_id], *allocation_counters_).first->second;
+        document_freqs[document_id] += inv_word_count;
+        if (forward_index_mode_ == ForwardIndexMode::COMPACT) {
+            term_ids.push_back(term_id);
+        }
+    }
+    
+    std::sort(term_ids.begin(), term_ids.end());
+    size_t unique_count = 0;
+    for (size_t i = 0; i < term_ids.size(); ++i) {
+        if (i == 0 || term_ids[i] != term_ids[i - 1]) {
+            ++unique_count;
+        }
+    }
+    // ровно один блок на документ
+    document_data.words.reserve(unique_count);
+    for (const uint32_t term_id : term_ids) {
+        if (document_data.words.empty() || document_data.words.back().term_id != term_id) {
+            document_data.words.push_back({term_id, 0});
+        }
+        ++document_data.words.back().count;
+    }
+    
+    if (impact_index_enabled_) {
+        AddImpactPostings(document_id, document_data.rating, words);
+    }
+}
+
+void SearchServer::AddImpactPostings(int document_id, int rating, std::vector<std::string_view> words) {
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    for (const auto word : words) {
+        const auto postings = word_to_document_freqs_.find(word);
+        word_to_impact_postings_.try_emplace(postings->first, *allocation_counters_).first->second
+            .insert({postings->second.at(document_id), rating, document_id});
+    }
+}
+
+void SearchServer::RemoveImpactPostings(int document_id, const std::vector<std::string_view>& words) {
+    const int rating = documents_.at(document_id).rating;
+    for (const auto word : words) {
+        const auto impact_postings = word_to_impact_postings_.find(word);
+        impact_postings->second.erase({word_to_document_freqs_.at(word).at(document_id), rating, document_id});
+        if (impact_postings->second.empty()) {
+            word_to_impact_postings_.erase(impact_postings);
+        }
+    }
+}
+
+void SearchServer::SetImpactIndexEnabled(bool enabled) {
+    if (enabled == impact_index_enabled_) {
+        return;
+    }
+    impact_index_enabled_ = enabled;
+    word_to_impact_postings_.clear();
+    if (!enabled) {
+        return;
+    }
+    for (const auto& [word, document_freqs] : word_to_document_freqs_) {
+        auto& impact_postings = word_to_impact_postings_.emplace_hint(word_to_impact_postings_.end(), word, ImpactPostings(*allocation_counters_))->second;
+        for (const auto [document_id, term_freq] : document_freqs) {
+            impact_postings.insert({term_freq, documents_.at(document_id).rating, document_id});
+        }
+    }
+}
+
+bool SearchServer::IsImpactIndexEnabled() const {
+    return impact_index_enabled_;
+}
+
+bool SearchServer::CanUseImpactIndex(const Query& query) const {
+    return impact_index_enabled_ && query.plus_words.size() == 1;
+}
+
+uint32_t SearchServer::AddTerm(std::string_view word) {
+    auto entry = words_.find(word);
+    if (entry != words_.end()) {
+        return entry->second;
     }
+    uint32_t term_id = static_cast<uint32_t>(term_words_.size());
+    if (!free_term_ids_.empty()) {
+        term_id = free_term_ids_.back();
+        free_term_ids_.pop_back();
+    } else {
+        term_words_.emplace_back();
+    }
+    entry = words_.emplace(std::string(word), term_id).first;
+    term_words_[term_id] = entry->first;
+    if (words_.size() > term_filter_.GetCapacity()) {
+        RebuildTermFilter();
+    } else {
+        term_filter_.Add(word);
+    }
+    return term_id;
+}
+
+void SearchServer::RemoveTerm(std::string_view word) {
+    const auto entry = words_.find(word);
+    free_term_ids_.push_back(entry->second);
+    term_words_[entry->second] = {};
+    words_.erase(entry);
+    if (++removed_term_count_ > term_filter_.GetCapacity() / 2) {
+        RebuildTermFilter();
+    }
+}
+
+void SearchServer::RebuildTermFilter() {
+    constexpr size_t MIN_TERM_FILTER_CAPACITY = 1024;
+    term_filter_ = TermFilter(std::max(2 * words_.size(), MIN_TERM_FILTER_CAPACITY), *allocation_counters_);
+    for (const auto& [word, _] : words_) {
+        term_filter_.Add(word);
+    }
+    removed_term_count_ = 0;
+}
+
+const SearchServer::DocumentFreqs* SearchServer::FindPostings(std::string_view word) const {
+    if (!term_filter_.MayContain(word)) {
+        return nullptr;
+    }
+    const auto postings = word_to_document_freqs_.find(word);
+    return postings == word_to_document_freqs_.end() ? nullptr : &postings->second;
 }
  
 int SearchServer::GetDocumentCount() const {
     return documents_.size();
 }
  
-std::set<int> ::const_iterator SearchServer::begin() const {
+SearchServer::DocumentIds::const_iterator SearchServer::begin() const {
     return document_ids_.begin();
 }
  
-std::set<int> ::const_iterator SearchServer::end() const {
+SearchServer::DocumentIds::const_iterator SearchServer::end() const {
     return document_ids_.end();
 }
  
-const std::map<std::string_view, double>& SearchServer::GetWordFrequencies(int document_id) const {
-    static const std::map<std::string_view, double> emptyes;
-    return (!ids_of_docs_to_word_freqs_.count(document_id)) ? emptyes : ids_of_docs_to_word_freqs_.at(document_id);
+SearchServer::WordFrequencies SearchServer::GetWordFrequencies(int document_id) const {
+    WordFrequencies word_freqs;
+    const auto document = documents_.find(document_id);
+    if (document == documents_.end()) {
+        return word_freqs;
+    }
+    
+    if (forward_index_mode_ == ForwardIndexMode::COMPACT) {
+        uint32_t word_count = 0;
+        for (const ForwardEntry& entry : document->second.words) {
+            word_count += entry.count;
+        }
+        for (const ForwardEntry& entry : document->second.words) {
+            word_freqs.emplace(term_words_[entry.term_id], static_cast<double>(entry.count) / word_count);
+        }
+    } else {
+        for (const auto& [word, document_freqs] : word_to_document_freqs_) {
+            const auto posting = document_freqs.find(document_id);
+            if (posting != document_freqs.end()) {
+                word_freqs.emplace_hint(word_freqs.end(), word, posting->second);
+            }
+        }
+    }
+    return word_freqs;
+}
+
+void SearchServer::SetForwardIndexMode(ForwardIndexMode mode) {
+    if (!documents_.empty()) {
+        throw std::logic_error("Forward index mode can be changed only on an empty server"s);
+    }
+    forward_index_mode_ = mode;
+}
+
+ForwardIndexMode SearchServer::GetForwardIndexMode() const {
+    return forward_index_mode_;
+}
+
+std::vector<std::string_view> SearchServer::GetDocumentWords(int document_id) const {
+    std::vector<std::string_view> words;
+    if (forward_index_mode_ == ForwardIndexMode::COMPACT) {
+        const auto& entries = documents_.at(document_id).words;
+        words.reserve(entries.size());
+        for (const ForwardEntry& entry : entries) {
+            words.push_back(term_words_[entry.term_id]);
+        }
+    } else {
+        for (const auto& [word, document_freqs] : word_to_document_freqs_) {
+            if (document_freqs.count(document_id) > 0) {
+                words.push_back(word);
+            }
+        }
+    }
+    return words;
+}
+
+MemoryStats SearchServer::GetMemoryStats() const {
+    // цвет и три указателя узла красно-чёрного дерева libstdc++
+    constexpr size_t TREE_NODE_OVERHEAD = 32;
+    const size_t inline_capacity = std::string().capacity();
+    const auto string_heap_bytes = [inline_capacity](const std::string& str) -> size_t {
+        return str.capacity() > inline_capacity ? str.capacity() + 1 : 0;
+    };
+    const auto fill_allocated = [this](MemoryUsage& usage, MemoryCategory category) {
+        const AllocationCounter& counter = allocation_counters_->Get(category);
+        usage.allocated_bytes = counter.bytes.load(std::memory_order_relaxed);
+        usage.allocated_blocks = counter.blocks.load(std::memory_order_relaxed);
+    };
+    
+    MemoryStats stats;
+    
+    stats.documents.entries = documents_.size();
+    stats.documents.estimated_bytes = documents_.size() * (TREE_NODE_OVERHEAD + sizeof(decltype(documents_)::value_type));
+    fill_allocated(stats.documents, MemoryCategory::DOCUMENTS);
+    
+    stats.document_ids.entries = document_ids_.size();
+    stats.document_ids.estimated_bytes = document_ids_.size() * (TREE_NODE_OVERHEAD + sizeof(int));
+    fill_allocated(stats.document_ids, MemoryCategory::DOCUMENT_IDS);
+    
+    stats.inverted_index.estimated_bytes = word_to_document_freqs_.size() * (TREE_NODE_OVERHEAD + sizeof(decltype(word_to_document_freqs_)::value_type));
+    for (const auto& [_, document_freqs] : word_to_document_freqs_) {
+        stats.inverted_index.entries += document_freqs.size();
+    }
+    stats.inverted_index.estimated_bytes += stats.inverted_index.entries * (TREE_NODE_OVERHEAD + sizeof(DocumentFreqs::value_type));
+    fill_allocated(stats.inverted_index, MemoryCategory::INVERTED_INDEX);
+    
+    for (const auto& [_, document_data] : documents_) {
+        stats.forward_index.entries += document_data.words.size();
+        stats.forward_index.estimated_bytes += document_data.words.capacity() * sizeof(ForwardEntry);
+    }
+    fill_allocated(stats.forward_index, MemoryCategory::FORWARD_INDEX);
+    
+    stats.dictionary.entries = words_.size();
+    stats.dictionary.estimated_bytes = words_.size() * (TREE_NODE_OVERHEAD + sizeof(decltype(words_)::value_type))
+                                     + term_words_.capacity() * sizeof(std::string_view)
+                                     + free_term_ids_.capacity() * sizeof(uint32_t)
+                                     + term_filter_.GetBytes();
+    for (const auto& [word, _] : words_) {
+        stats.dictionary.estimated_bytes += string_heap_bytes(word);
+    }
+    fill_allocated(stats.dictionary, MemoryCategory::DICTIONARY);
+    
+    stats.stop_words.entries = stop_words_.size();
+    stats.stop_words.estimated_bytes = stop_words_.size() * sizeof(std::string) + stop_words_.GetTableBytes();
+    for (const std::string& word : stop_words_) {
+        stats.stop_words.estimated_bytes += string_heap_bytes(word);
+    }
+    fill_allocated(stats.stop_words, MemoryCategory::STOP_WORDS);
+    
+    stats.impact_index.estimated_bytes = word_to_impact_postings_.size() * (TREE_NODE_OVERHEAD + sizeof(decltype(word_to_impact_postings_)::value_type));
+    for (const auto& [_, impact_postings] : word_to_impact_postings_) {
+        stats.impact_index.entries += impact_postings.size();
+    }
+    stats.impact_index.estimated_bytes += stats.impact_index.entries * (TREE_NODE_OVERHEAD + sizeof(ImpactPosting));
+    fill_allocated(stats.impact_index, MemoryCategory::IMPACT_INDEX);
+    
+    return stats;
 }
 
 void SearchServer::RemoveDocument(int document_id) {
@@ -44,65 +375,192 @@ void SearchServer::RemoveDocument(int document_id) {
 }
 
 void SearchServer::RemoveDocument(const std::execution::sequenced_policy&, int document_id) {
-    auto helper = std::find(document_ids_.begin(), 
-                            document_ids_.end(), 
-                            document_id);
-    
-    if (helper == document_ids_.end()) {
+    if (documents_.count(document_id) == 0) {
         return;
-    } else {
-        document_ids_.erase(helper);
     }
-        
-    documents_.erase(document_id);
-    std::for_each(word_to_document_freqs_.begin(), 
-                  word_to_document_freqs_.end(), 
-                  [&](auto& helper) {
-                      helper.second.erase(document_id); 
-                  });
+    
+    const auto words = GetDocumentWords(document_id);
+    if (impact_index_enabled_) {
+        RemoveImpactPostings(document_id, words);
+    }
+    for (const auto word : words) {
+        word_to_document_freqs_.at(word).erase(document_id);
+    }
+    EraseDocumentData(document_id, words);
 }
 
 void SearchServer::RemoveDocument(const std::execution::parallel_policy&, int document_id) {
-    if (ids_of_docs_to_word_freqs_.count(document_id) == 0) return;
-    std::vector<std::string_view> helper(ids_of_docs_to_word_freqs_.at(document_id).size());
+    if (documents_.count(document_id) == 0) return;
+    const auto words = GetDocumentWords(document_id);
+    if (impact_index_enabled_) {
+        RemoveImpactPostings(document_id, words);
+    }
+    std::vector<DocumentFreqs*> helper(words.size());
     
     std::transform(std::execution::par,
-                   ids_of_docs_to_word_freqs_[document_id].begin(),
-                   ids_of_docs_to_word_freqs_[document_id].end(),
+                   words.begin(),
+                   words.end(),
                    helper.begin(),
-                   [] (const auto& m){
-                       return m.first;
+                   [this] (std::string_view word){
+                       return &word_to_document_freqs_.at(word);
                    });
     
     std::for_each(std::execution::par,
                    helper.begin(), 
                    helper.end(), 
-                   [&](auto& m) { 
-                       word_to_document_freqs_[m].erase(document_id);
+                   [document_id](auto* m) { 
+                       m->erase(document_id);
                    });
     
+    EraseDocumentData(document_id, words);
+}
+
+void SearchServer::EraseDocumentData(int document_id, const std::vector<std::string_view>& words) {
+    for (const auto word : words) {
+        const auto postings = word_to_document_freqs_.find(word);
+        if (postings->second.empty()) {
+            word_to_document_freqs_.erase(postings);
+            RemoveTerm(word);
+        }
+    }
+    
     documents_.erase(document_id);
     document_ids_.erase(document_id);
-    ids_of_docs_to_word_freqs_.erase(document_id);
+}
+
+std::vector<Document> SearchServer::FindTopDocuments(const CorpusStatistics& statistics,
+                                                     std::string_view raw_query,
+                                                     DocumentStatus status) const {
+    TRACE_SCOPE(TraceStage::FIND_TOP_DOCUMENTS);
+    const auto query = ParseQuery(raw_query, true);
+    return SelectTopDocuments(std::execution::seq,
+                              FindAllDocuments(std::execution::seq,
+                                               query,
+                                               [status](int, DocumentStatus document_status, int) {
+                                                   return document_status == status;
+                                               },
+                                               &statistics));
+}
+
+SearchResult SearchServer::FindTopDocuments(const SearchControl& control,
+                                           std::string_view raw_query,
+                                           DocumentStatus status) const {
+    return FindTopDocuments(control,
+                            raw_query,
+                            [status](int, DocumentStatus document_status, int) {
+                                return document_status == status;
+                            });
+}
+
+SearchResult SearchServer::FindTopDocuments(const SearchControl& control,
+                                           std::string_view raw_query) const {
+    return FindTopDocuments(control, raw_query, DocumentStatus::ACTUAL);
+}
+
+SearchPage SearchServer::FindTopDocuments(std::string_view raw_query,
+                                         const SearchCursor& after,
+                                         size_t page_size,
+                                         DocumentStatus status) const {
+    return FindTopDocuments(raw_query,
+                            after,
+                            page_size,
+                            [status](int, DocumentStatus document_status, int) {
+                                return document_status == status;
+                            });
+}
+
+SearchPage SearchServer::FindTopDocuments(std::string_view raw_query,
+                                         const SearchCursor& after,
+                                         size_t page_size) const {
+    return FindTopDocuments(raw_query, after, page_size, DocumentStatus::ACTUAL);
+}
+
+bool SearchServer::IsMoreRelevant(const Document& lhs, const Document& rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) >= EPSILON) {
+        return lhs.relevance > rhs.relevance;
+    }
+    if (lhs.rating != rhs.rating) {
+        return lhs.rating > rhs.rating;
+    }
+    return lhs.id < rhs.id;
+}
+
+// Релевантность округляется до сетки с шагом EPSILON: попарное сравнение
+// |a - b| < EPSILON нетранзитивно, и курсор по такому порядку мог зациклиться.
+bool SearchServer::IsRankedBefore(const Document& lhs, const Document& rhs) const {
+    const long long lhs_relevance = std::llround(lhs.relevance / EPSILON);
+    const long long rhs_relevance = std::llround(rhs.relevance / EPSILON);
+    return std::tie(rhs_relevance, rhs.rating, lhs.id) < std::tie(lhs_relevance, lhs.rating, rhs.id);
+}
+
+SearchPage SearchServer::SelectPage(std::vector<Document> matched_documents,
+                                    const SearchCursor& after,
+                                    size_t page_size) const {
+    TRACE_SCOPE(TraceStage::SORT_RESULTS);
+    if (after.is_started_) {
+        const Document last(after.id_, after.relevance_, after.rating_);
+        matched_documents.erase(std::remove_if(matched_documents.begin(),
+                                               matched_documents.end(),
+                                               [this, &last](const Document& document) {
+                                                   return !IsRankedBefore(last, document);
+                                               }),
+                                matched_documents.end());
+    }
+    
+    const auto is_ranked_before = [this](const Document& lhs, const Document& rhs) {
+        return IsRankedBefore(lhs, rhs);
+    };
+    const bool has_more = matched_documents.size() > page_size;
+    if (has_more) {
+        std::partial_sort(matched_documents.begin(),
+                          matched_documents.begin() + page_size,
+                          matched_documents.end(),
+                          is_ranked_before);
+        matched_documents.resize(page_size);
+    } else {
+        std::sort(matched_documents.begin(), matched_documents.end(), is_ranked_before);
+    }
+    
+    SearchPage page;
+    page.documents = std::move(matched_documents);
+    if (has_more) {
+        const Document& last = page.documents.back();
+        page.next.relevance_ = last.relevance;
+        page.next.rating_ = last.rating;
+        page.next.id_ = last.id;
+        page.next.is_started_ = true;
+    } else {
+        page.next.is_end_ = true;
+    }
+    return page;
+}
+
+CorpusStatistics SearchServer::GetCorpusStatistics(std::string_view raw_query) const {
+    const auto query = ParseQuery(raw_query, true);
+    CorpusStatistics statistics;
+    statistics.document_count = GetDocumentCount();
+    for (std::string_view word : query.plus_words) {
+        const auto postings = word_to_document_freqs_.find(word);
+        statistics.document_freqs[std::string(word)] =
+            postings == word_to_document_freqs_.end() ? 0 : static_cast<int>(postings->second.size());
+    }
+    return statistics;
 }
 
 MatchTuple SearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+    TRACE_SCOPE(TraceStage::MATCH_DOCUMENT);
     const auto query = ParseQuery(raw_query, true);
     std::vector<std::string_view> matched_words;
     for (auto& word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
+        const DocumentFreqs* postings = FindPostings(word);
+        if (postings != nullptr && postings->count(document_id)) {
             return { matched_words, documents_.at(document_id).status };
         }
     }
 
     for (auto& word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
+        const DocumentFreqs* postings = FindPostings(word);
+        if (postings != nullptr && postings->count(document_id)) {
             matched_words.push_back(word);
         }
     }
@@ -117,21 +575,22 @@ MatchTuple SearchServer::MatchDocument(std::execution::sequenced_policy policy,
 
 MatchTuple SearchServer::MatchDocument(std::execution::parallel_policy policy,
                                        std::string_view raw_query, const int& document_id) const {
+    TRACE_SCOPE(TraceStage::MATCH_DOCUMENT);
     if (documents_.find(document_id) == documents_.end()) throw std::out_of_range("Invalid document_id");
     
     const auto& query = ParseQuery(raw_query, false);
     std::vector<std::string_view> matched_words(query.plus_words.size());
     
     const auto& check = [this, document_id](std::string_view word) {
-        const auto helper = word_to_document_freqs_.find(word);
-        return helper!= word_to_document_freqs_.end() && helper->second.count(document_id);
+        const DocumentFreqs* helper = FindPostings(word);
+        return helper != nullptr && helper->count(document_id);
     };
  
     if (std::any_of(std::execution::par, 
                     query.minus_words.begin(), 
                     query.minus_words.end(), 
                     check)) {
-                        return {{}, documents_.at(document_id).status};
+                        return {std::vector<std::string_view>{}, documents_.at(document_id).status};
     }
     
     auto end = std::copy_if(std::execution::par, 
@@ -148,7 +607,7 @@ MatchTuple SearchServer::MatchDocument(std::execution::parallel_policy policy,
 }
  
 bool SearchServer::IsStopWord(std::string_view word) const {
-    return stop_words_.count(word) > 0;
+    return stop_words_.Contains(word);
 }
  
 bool SearchServer::IsValidWord(std::string_view word) {
@@ -201,6 +660,7 @@ SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view& text) con
 }
  
 SearchServer::Query SearchServer::ParseQuery(std::string_view& text, bool is_not_sort) const {
+    TRACE_SCOPE(TraceStage::PARSE_QUERY);
     Query result;
     for (auto& word : SplitIntoWords(text)) {
         const auto query_word = ParseQueryWord(word);
@@ -228,4 +688,14 @@ SearchServer::Query SearchServer::ParseQuery(std::string_view& text, bool is_not
  
 double SearchServer::ComputeWordInverseDocumentFreq(std::string_view& word) const {
     return log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
-}
\ No newline at end of file
+}
+
+double SearchServer::ComputeWordInverseDocumentFreq(std::string_view word, size_t document_freq, const CorpusStatistics* statistics) const {
+    if (statistics != nullptr) {
+        const auto global_document_freq = statistics->document_freqs.find(word);
+        if (global_document_freq != statistics->document_freqs.end() && global_document_freq->second != 0) {
+            return log(statistics->document_count * 1.0 / global_document_freq->second);
+        }
+    }
+    return log(GetDocumentCount() * 1.0 / document_freq);
+}
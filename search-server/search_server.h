@@ -1,9 +1,11 @@
 #pragma once
 #include <tuple>
+#include <cstdint>
 #include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <set>
 #include <stdexcept>
 #include <execution>
@@ -18,26 +20,72 @@
 #include "document.h"
 #include "log_duration.h" 
 #include "concurrent_map.h"
+#include "search_control.h"
+#include "search_cursor.h"
+#include "memory_stats.h"
+#include "tracing.h"
+#include "word_filters.h"
  
 using namespace std::string_literals;
 using MatchTuple = std::tuple<std::vector<std::string_view>, DocumentStatus>;
+
+// COMPACT — на документ один массив (term id, число вхождений), отсортированный по term id.
+// DISABLED — прямого индекса нет: GetWordFrequencies и RemoveDocument просматривают весь обратный индекс.
+enum class ForwardIndexMode {
+    COMPACT,
+    DISABLED,
+};
  
 class SearchServer {
 public:
+    using WordFrequencies = std::map<std::string_view, double>;
+    using DocumentIds = CountedSet<int, MemoryCategory::DOCUMENT_IDS>;
+    
+    static constexpr double EPSILON = 1e-6;
+    static constexpr size_t MAX_RESULT_DOCUMENT_COUNT = 5;
+    
+    // Порядок выдачи FindTopDocuments: релевантность, отличающаяся меньше чем на EPSILON,
+    // считается равной, затем рейтинг по убыванию и id по возрастанию.
+    static bool IsMoreRelevant(const Document& lhs, const Document& rhs);
+    
     template <typename StringContainer>
     SearchServer(const StringContainer& stop_words);
     SearchServer(const std::string& stop_words_text) : SearchServer(SplitIntoWords(std::string_view(stop_words_text))){}
     SearchServer(std::string_view& stop_words_text) : SearchServer(SplitIntoWords(stop_words_text)){}
     SearchServer() = default;
+    // Копия получает собственные счётчики памяти. Перемещённый сервер
+    // можно только уничтожить или присвоить ему новое значение.
+    SearchServer(const SearchServer& other);
+    SearchServer(SearchServer&& other) = default;
+    SearchServer& operator=(SearchServer other) noexcept;
     
     void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+    // Для массовой загрузки: words — результат TokenizeDocument. Слова проверяются,
+    // как в тексте документа, стоп-слова отбрасываются. Текст документа
+    // не сохраняется, в индекс копируются только новые слова словаря.
+    void AddDocument(int document_id, const std::vector<std::string_view>& words, DocumentStatus status, const std::vector<int>& ratings);
+    
+    // Слова документа без стоп-слов. Не меняет индекс, можно вызывать из нескольких потоков.
+    std::vector<std::string_view> TokenizeDocument(std::string_view document) const;
     
     int GetDocumentCount() const;
     
-    std::set<int> ::const_iterator begin() const;
-    std::set<int> ::const_iterator end() const;
+    DocumentIds::const_iterator begin() const;
+    DocumentIds::const_iterator end() const;
+    
+    // Собирается по запросу из прямого индекса, а если он отключён — из обратного.
+    WordFrequencies GetWordFrequencies(int document_id) const;
+    
+    // Режим можно менять, только пока в сервере нет документов.
+    void SetForwardIndexMode(ForwardIndexMode mode);
+    ForwardIndexMode GetForwardIndexMode() const;
+    
+    // Дополнительные списки постингов по убыванию tf: запрос из одного плюс-слова
+    // читает только их начало. При включении строятся по текущему индексу.
+    void SetImpactIndexEnabled(bool enabled);
+    bool IsImpactIndexEnabled() const;
     
-    const std::map<std::string_view, double>& GetWordFrequencies(int document_id) const;
+    MemoryStats GetMemoryStats() const;
     
     void RemoveDocument(int document_id);
     void RemoveDocument(const std::execution::sequenced_policy&, int document_id);
@@ -60,27 +108,17 @@ public:
     std::vector<Document> FindTopDocuments(const Policy& policy,
                                                          std::string_view raw_query, 
                                                          DocumentPredicate document_predicate) const {
+        TRACE_SCOPE(TraceStage::FIND_TOP_DOCUMENTS);
         const auto query = ParseQuery(raw_query, true);
-        auto matched_documents = FindAllDocuments(policy,
-                                                  query, 
-                                                  document_predicate);
-    
-        sort(policy,
-             matched_documents.begin(), 
-             matched_documents.end(), 
-             [this](const Document& lhs, const Document& rhs) {
-                 if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
-                     return lhs.rating > rhs.rating;
-                 } else {
-                     return lhs.relevance > rhs.relevance;
-                 }
-             });
-    
-        if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-            matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+        if (CanUseImpactIndex(query)) {
+            return SelectTopDocuments(policy,
+                                      FindImpactCandidates(query,
+                                                           document_predicate));
         }
-    
-        return matched_documents;
+        return SelectTopDocuments(policy,
+                                  FindAllDocuments(policy,
+                                                   query, 
+                                                   document_predicate));
     }
 
     std::vector<Document> FindTopDocuments(std::string_view raw_query, 
@@ -114,29 +152,152 @@ public:
                                 raw_query,
                                 DocumentStatus::ACTUAL);
     }
+
+    // Для шардированного индекса: IDF считается по статистике всего корпуса.
+    std::vector<Document> FindTopDocuments(const CorpusStatistics& statistics,
+                                           std::string_view raw_query,
+                                           DocumentStatus status) const;
+    CorpusStatistics GetCorpusStatistics(std::string_view raw_query) const;
+
+    // Дедлайн и отмена проверяются между блоками постингов; по истечении дедлайна
+    // возвращаются лучшие из уже просмотренных документов со статусом TRUNCATED.
+    template <typename DocumentPredicate>
+    SearchResult FindTopDocuments(const SearchControl& control,
+                                  std::string_view raw_query,
+                                  DocumentPredicate document_predicate) const {
+        TRACE_SCOPE(TraceStage::FIND_TOP_DOCUMENTS);
+        QueryGuard guard(control);
+        if (guard.ShouldStop()) {
+            return guard.MakeResult({});
+        }
+        const auto query = ParseQuery(raw_query, true);
+        auto matched_documents = FindAllDocuments(std::execution::seq,
+                                                  query,
+                                                  document_predicate,
+                                                  nullptr,
+                                                  &guard);
+        return guard.MakeResult(SelectTopDocuments(std::execution::seq, std::move(matched_documents)));
+    }
+
+    SearchResult FindTopDocuments(const SearchControl& control,
+                                  std::string_view raw_query,
+                                  DocumentStatus status) const;
+    SearchResult FindTopDocuments(const SearchControl& control,
+                                  std::string_view raw_query) const;
+
+    // Постраничная выдача: page_size документов строго после курсора.
+    // Пустая страница не сдвинула бы курсор, поэтому page_size == 0 — ошибка.
+    // Каждая страница — отбор top-K из найденных, без полной сортировки.
+    template <typename Policy, typename DocumentPredicate>
+    SearchPage FindTopDocuments(const Policy& policy,
+                                std::string_view raw_query,
+                                const SearchCursor& after,
+                                size_t page_size,
+                                DocumentPredicate document_predicate) const {
+        TRACE_SCOPE(TraceStage::FIND_TOP_DOCUMENTS);
+        if (page_size == 0) {
+            throw std::invalid_argument("Page size must be positive"s);
+        }
+        if (after.IsEnd()) {
+            return {{}, after};
+        }
+        const auto query = ParseQuery(raw_query, true);
+        return SelectPage(FindAllDocuments(policy,
+                                           query,
+                                           document_predicate),
+                          after,
+                          page_size);
+    }
+
+    template <typename DocumentPredicate>
+    SearchPage FindTopDocuments(std::string_view raw_query,
+                                const SearchCursor& after,
+                                size_t page_size,
+                                DocumentPredicate document_predicate) const {
+        return FindTopDocuments(std::execution::seq, raw_query, after, page_size, document_predicate);
+    }
+
+    SearchPage FindTopDocuments(std::string_view raw_query,
+                                const SearchCursor& after,
+                                size_t page_size,
+                                DocumentStatus status) const;
+    SearchPage FindTopDocuments(std::string_view raw_query,
+                                const SearchCursor& after,
+                                size_t page_size) const;
  
 private:
+    friend class CompactScorer;
+
+    struct ForwardEntry {
+        uint32_t term_id;
+        uint32_t count;
+    };
+    using ForwardEntries = CountedVector<ForwardEntry, MemoryCategory::FORWARD_INDEX>;
+    
+    // Текст документа не хранится: слова индекса живут в словаре words_.
     struct DocumentData {
-        std::string data_string_;
         int rating;
         DocumentStatus status;
+        ForwardEntries words;
     };
     
-    const double EPSILON = 1e-6;
-    const int MAX_RESULT_DOCUMENT_COUNT = 5;
+    using DocumentFreqs = CountedMap<int, double, MemoryCategory::INVERTED_INDEX>;
+    
+    // объявлены первыми: контейнеры ниже получают аллокаторы с этими счётчиками.
+    // Счётчики в куче, чтобы их адрес не менялся при перемещении сервера.
+    std::unique_ptr<AllocationCounters> allocation_counters_ = std::make_unique<AllocationCounters>();
+    StopWordTable stop_words_;
+    // слово → term id; term_words_ — обратное отображение, освободившиеся id переиспользуются
+    CountedMap<std::string, uint32_t, MemoryCategory::DICTIONARY, std::less<>> words_{*allocation_counters_};
+    CountedVector<std::string_view, MemoryCategory::DICTIONARY> term_words_{*allocation_counters_};
+    CountedVector<uint32_t, MemoryCategory::DICTIONARY> free_term_ids_{*allocation_counters_};
+    // отсекает незнакомые слова запроса до поиска в дереве; перестраивается
+    // при переполнении и после удаления половины слов
+    TermFilter term_filter_{0, *allocation_counters_};
+    size_t removed_term_count_ = 0;
+    CountedMap<std::string_view, DocumentFreqs, MemoryCategory::INVERTED_INDEX> word_to_document_freqs_{*allocation_counters_};
+    CountedMap<int, DocumentData, MemoryCategory::DOCUMENTS> documents_{*allocation_counters_};
+    DocumentIds document_ids_{*allocation_counters_};
+    ForwardIndexMode forward_index_mode_ = ForwardIndexMode::COMPACT;
+    
+    // tf по убыванию, затем рейтинг по убыванию и id по возрастанию
+    struct ImpactPosting {
+        double term_freq;
+        int rating;
+        int document_id;
+        
+        bool operator<(const ImpactPosting& other) const {
+            return std::tie(other.term_freq, other.rating, document_id)
+                 < std::tie(term_freq, rating, other.document_id);
+        }
+    };
+    using ImpactPostings = CountedSet<ImpactPosting, MemoryCategory::IMPACT_INDEX>;
     
-    const std::set<std::string, std::less<>> stop_words_;
-    std::map<std::string_view, std::map<int, double>> word_to_document_freqs_;
-    std::map<int, DocumentData> documents_;
-    std::set<int> document_ids_;
-    std::map<int, std::map<std::string_view, double>> ids_of_docs_to_word_freqs_;
+    bool impact_index_enabled_ = false;
+    CountedMap<std::string_view, ImpactPostings, MemoryCategory::IMPACT_INDEX> word_to_impact_postings_{*allocation_counters_};
  
+    template <typename StringContainer>
+    static StopWordTable MakeStopWords(const StringContainer& stop_words, AllocationCounters& counters) {
+        return StopWordTable(MakeUniqueNonEmptyStrings(stop_words), counters);
+    }
+    
+    void Swap(SearchServer& other) noexcept;
+    
     bool IsStopWord(std::string_view word) const;
     static bool IsValidWord(std::string_view word);
     
     std::vector<std::string_view> SplitIntoWordsNoStop(std::string_view text) const;
     
     static int ComputeAverageRating(const std::vector<int>& ratings);
+    void IndexWords(int document_id, DocumentData& document_data, const std::vector<std::string_view>& words);
+    uint32_t AddTerm(std::string_view word);
+    void RemoveTerm(std::string_view word);
+    void RebuildTermFilter();
+    const DocumentFreqs* FindPostings(std::string_view word) const;
+    std::vector<std::string_view> GetDocumentWords(int document_id) const;
+    void EraseDocumentData(int document_id, const std::vector<std::string_view>& words);
+    void AddImpactPostings(int document_id, int rating, std::vector<std::string_view> words);
+    void RemoveImpactPostings(int document_id, const std::vector<std::string_view>& words);
  
     struct QueryWord {
         std::string_view data;
@@ -153,6 +314,7 @@ private:
  
     Query ParseQuery(std::string_view& text, bool is_not_sort) const;
     double ComputeWordInverseDocumentFreq(std::string_view& word) const;
+    double ComputeWordInverseDocumentFreq(std::string_view word, size_t document_freq, const CorpusStatistics* statistics) const;
  
     template <typename DocumentPredicate>
     std::vector<Document> FindAllDocuments(const Query& query, 
@@ -160,16 +322,32 @@ private:
     template <typename DocumentPredicate>
     std::vector<Document> FindAllDocuments(const std::execution::sequenced_policy&,
                                            const Query& query, 
-                                           DocumentPredicate document_predicate) const;
+                                           DocumentPredicate document_predicate,
+                                           const CorpusStatistics* statistics = nullptr,
+                                           QueryGuard* guard = nullptr) const;
     template <typename DocumentPredicate>
     std::vector<Document> FindAllDocuments(const std::execution::parallel_policy&,
                                            const Query& query, 
-                                           DocumentPredicate document_predicate) const;
+                                           DocumentPredicate document_predicate,
+                                           const CorpusStatistics* statistics = nullptr) const;
+    
+    bool CanUseImpactIndex(const Query& query) const;
+    template <typename DocumentPredicate>
+    std::vector<Document> FindImpactCandidates(const Query& query,
+                                               DocumentPredicate document_predicate) const;
     
+    template <typename Policy>
+    std::vector<Document> SelectTopDocuments(const Policy& policy,
+                                             std::vector<Document> matched_documents) const;
+    bool IsRankedBefore(const Document& lhs, const Document& rhs) const;
+    SearchPage SelectPage(std::vector<Document> matched_documents,
+                          const SearchCursor& after,
+                          size_t page_size) const;
+
 };
  
 template <typename StringContainer>
-SearchServer::SearchServer(const StringContainer& stop_words) : stop_words_(MakeUniqueNonEmptyStrings(stop_words)){
+SearchServer::SearchServer(const StringContainer& stop_words) : stop_words_(MakeStopWords(stop_words, *allocation_counters_)){
     if (!all_of(stop_words_.begin(), stop_words_.end(), IsValidWord)) {
         throw std::invalid_argument("Some of stop words are invalid"s);
     }
@@ -186,15 +364,28 @@ std::vector<Document> SearchServer::FindAllDocuments(const Query& query,
 template <typename DocumentPredicate>
 std::vector<Document> SearchServer::FindAllDocuments(const std::execution::sequenced_policy&,
                                                      const Query& query, 
-                                                     DocumentPredicate document_predicate) const {
+                                                     DocumentPredicate document_predicate,
+                                                     const CorpusStatistics* statistics,
+                                                     QueryGuard* guard) const {
+    TRACE_SCOPE(TraceStage::FIND_ALL_DOCUMENTS);
     std::map<int, double> document_to_relevance;
     
     for (std::string_view word : query.plus_words) {
-            if (word_to_document_freqs_.count(word) == 0) {
+            const DocumentFreqs* postings = FindPostings(word);
+            if (postings == nullptr) {
                 continue;
             }
-            const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-            for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
+            if (guard != nullptr && guard->ShouldStop()) {
+                break;
+            }
+            const double inverse_document_freq = ComputeWordInverseDocumentFreq(word, postings->size(), statistics);
+            size_t posting_count = 0;
+            for (const auto [document_id, term_freq] : *postings) {
+                if (guard != nullptr
+                    && ++posting_count % QueryGuard::POSTING_BLOCK_SIZE == 0
+                    && guard->ShouldStop()) {
+                    break;
+                }
                 const auto& document_data = documents_.at(document_id);
                 if (document_predicate(document_id, 
                                        document_data.status, 
@@ -204,11 +395,13 @@ std::vector<Document> SearchServer::FindAllDocuments(const std::execution::seque
             }
         }
  
+        // минус-слова применяются и после остановки, чтобы не вернуть исключённые документы
         for (const auto word : query.minus_words) {
-            if (word_to_document_freqs_.count(word) == 0) {
+            const DocumentFreqs* postings = FindPostings(word);
+            if (postings == nullptr) {
                 continue;
             }
-            for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
+            for (const auto [document_id, _] : *postings) {
                 document_to_relevance.erase(document_id);
             }
         }
@@ -226,18 +419,22 @@ std::vector<Document> SearchServer::FindAllDocuments(const std::execution::seque
 template <typename DocumentPredicate>
 std::vector<Document> SearchServer::FindAllDocuments(const std::execution::parallel_policy&,
                                                      const Query& query, 
-                                                     DocumentPredicate document_predicate) const {
+                                                     DocumentPredicate document_predicate,
+                                                     const CorpusStatistics* statistics) const {
+    TRACE_SCOPE(TraceStage::FIND_ALL_DOCUMENTS);
     const int BUCKET_COUNT = 101;
     ConcurrentMap<int, double> document_to_relevance(BUCKET_COUNT);
  
     const auto plus_func = [this, 
                        &document_predicate, 
-                       &document_to_relevance] (std::string_view word) {
-                           if (word_to_document_freqs_.count(word) == 0) {//
+                       &document_to_relevance,
+                       statistics] (std::string_view word) {
+                           const DocumentFreqs* postings = FindPostings(word);
+                           if (postings == nullptr) {
                                 return;
                            }
-                           const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-                           for (const auto& [document_id, term_freq] : word_to_document_freqs_.at(word)) {
+                           const double inverse_document_freq = ComputeWordInverseDocumentFreq(word, postings->size(), statistics);
+                           for (const auto& [document_id, term_freq] : *postings) {
                                const auto& document_data = documents_.at(document_id);//
                                if (document_predicate(document_id, 
                                                       document_data.status, 
@@ -253,10 +450,11 @@ std::vector<Document> SearchServer::FindAllDocuments(const std::execution::paral
              plus_func);
  
     const auto minus_erase_func = [&](std::string_view word) {
-        if (word_to_document_freqs_.count(word) == 0) {
+        const DocumentFreqs* postings = FindPostings(word);
+        if (postings == nullptr) {
             return;
         }
-        for (const auto& [document_id, _] : word_to_document_freqs_.at(word)) {
+        for (const auto& [document_id, _] : *postings) {
             document_to_relevance.Erase(document_id);
         }
     };
@@ -276,4 +474,64 @@ std::vector<Document> SearchServer::FindAllDocuments(const std::execution::paral
     }
     
     return matched_documents;
-}
\ No newline at end of file
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindImpactCandidates(const Query& query,
+                                                         DocumentPredicate document_predicate) const {
+    TRACE_SCOPE(TraceStage::FIND_ALL_DOCUMENTS);
+    std::vector<Document> candidates;
+    const std::string_view word = query.plus_words.front();
+    const DocumentFreqs* document_freqs = FindPostings(word);
+    if (document_freqs == nullptr) {
+        return candidates;
+    }
+    const auto postings = word_to_impact_postings_.find(word);
+    
+    std::vector<const DocumentFreqs*> minus_postings;
+    for (const auto minus_word : query.minus_words) {
+        if (const DocumentFreqs* minus_freqs = FindPostings(minus_word)) {
+            minus_postings.push_back(minus_freqs);
+        }
+    }
+    
+    const double inverse_document_freq = ComputeWordInverseDocumentFreq(word, document_freqs->size(), nullptr);
+    for (const ImpactPosting& posting : postings->second) {
+        const double relevance = posting.term_freq * inverse_document_freq;
+        // дальше только документы, отстающие от последнего места выдачи больше чем на EPSILON
+        if (candidates.size() >= MAX_RESULT_DOCUMENT_COUNT
+            && candidates[MAX_RESULT_DOCUMENT_COUNT - 1].relevance - relevance >= EPSILON) {
+            break;
+        }
+        const auto& document_data = documents_.at(posting.document_id);
+        if (!document_predicate(posting.document_id,
+                                document_data.status,
+                                document_data.rating)) {
+            continue;
+        }
+        if (std::any_of(minus_postings.begin(), minus_postings.end(),
+                        [&posting](const DocumentFreqs* minus_freqs) {
+                            return minus_freqs->count(posting.document_id) > 0;
+                        })) {
+            continue;
+        }
+        candidates.push_back({posting.document_id, relevance, posting.rating});
+    }
+    return candidates;
+}
+
+template <typename Policy>
+std::vector<Document> SearchServer::SelectTopDocuments(const Policy& policy,
+                                                       std::vector<Document> matched_documents) const {
+    TRACE_SCOPE(TraceStage::SORT_RESULTS);
+    sort(policy,
+         matched_documents.begin(), 
+         matched_documents.end(), 
+         IsMoreRelevant);
+    
+    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
+        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+    }
+    
+    return matched_documents;
+}
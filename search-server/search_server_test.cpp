@@ -0,0 +1,572 @@
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "compact_scorer.h"
+#include "process_queries.h"
+#include "search_server.h"
+#include "test_framework.h"
+
+using namespace std;
+
+// Соседние документы отличаются по релевантности меньше чем на EPSILON,
+// крайние — больше: при попарном сравнении с EPSILON порядок нетранзитивен.
+void TestCursorPaginationTerminates() {
+    SearchServer search_server("и в на"s);
+    for (int i = 0; i < 8; ++i) {
+        string text = "a"s;
+        for (int j = 0; j < 999 + i; ++j) {
+            text += " x"s;
+        }
+        search_server.AddDocument(i, text, DocumentStatus::ACTUAL, {i});
+    }
+    for (int i = 8; i < 16; ++i) {
+        search_server.AddDocument(i, "b"s, DocumentStatus::ACTUAL, {1});
+    }
+
+    vector<int> ids;
+    SearchCursor cursor;
+    for (int page = 0; page < 100 && !cursor.IsEnd(); ++page) {
+        const SearchPage result = search_server.FindTopDocuments("a"s, cursor, 1);
+        for (const Document& document : result.documents) {
+            ids.push_back(document.id);
+        }
+        cursor = result.next;
+    }
+    ASSERT(cursor.IsEnd());
+    ASSERT_EQUAL(ids.size(), 8u);
+    ASSERT_EQUAL(set<int>(ids.begin(), ids.end()).size(), 8u);
+
+    // страницы разного размера дают одну и ту же последовательность
+    vector<int> paged_by_three;
+    cursor = SearchCursor();
+    while (!cursor.IsEnd()) {
+        const SearchPage result = search_server.FindTopDocuments("a"s, cursor, 3);
+        for (const Document& document : result.documents) {
+            paged_by_three.push_back(document.id);
+        }
+        cursor = result.next;
+    }
+    ASSERT(paged_by_three == ids);
+
+    // пустая страница не сдвигает курсор: цикл по страницам не закончился бы
+    ASSERT_THROWS(search_server.FindTopDocuments("a"s, SearchCursor(), 0), invalid_argument);
+    ASSERT_THROWS(search_server.FindTopDocuments(std::execution::par, "a"s, cursor, 0,
+                                                 [](int, DocumentStatus, int) { return true; }),
+                  invalid_argument);
+}
+
+namespace {
+
+void AssertSameRanking(const vector<Document>& actual, const vector<Document>& expected, const string& query) {
+    ASSERT_EQUAL_HINT(actual.size(), expected.size(), query);
+    for (size_t i = 0; i < actual.size(); ++i) {
+        // при точном равенстве релевантности и рейтинга порядок id не определён
+        ASSERT_HINT(abs(actual[i].relevance - expected[i].relevance) < 1e-12, query);
+        ASSERT_EQUAL_HINT(actual[i].rating, expected[i].rating, query);
+    }
+}
+
+void AssertImpactMatchesFullScan(const SearchServer& indexed, const SearchServer& reference,
+                                 const vector<string>& dictionary) {
+    ASSERT(indexed.IsImpactIndexEnabled());
+    ASSERT(!reference.IsImpactIndexEnabled());
+    const auto even_rating = [](int, DocumentStatus, int rating) {
+        return rating % 2 == 0;
+    };
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+        const string& word = dictionary[i];
+        const vector<string> queries = {
+            word,
+            word + " -"s + dictionary[(i + 1) % dictionary.size()],
+            word + " -"s + dictionary[(i + 3) % dictionary.size()] + " -"s + dictionary[(i + 5) % dictionary.size()],
+            word + " -несуществующее"s,
+        };
+        for (const string& query : queries) {
+            AssertSameRanking(indexed.FindTopDocuments(query), reference.FindTopDocuments(query), query);
+            AssertSameRanking(indexed.FindTopDocuments(query, DocumentStatus::BANNED),
+                              reference.FindTopDocuments(query, DocumentStatus::BANNED), query);
+            AssertSameRanking(indexed.FindTopDocuments(query, even_rating),
+                              reference.FindTopDocuments(query, even_rating), query);
+            AssertSameRanking(indexed.FindTopDocuments(std::execution::par, query),
+                              reference.FindTopDocuments(query), query);
+        }
+    }
+}
+
+}  // namespace
+
+// Списки постингов по убыванию tf поддерживаются при каждом AddDocument и
+// RemoveDocument; выдача должна совпадать с полным просмотром обратного индекса.
+void TestImpactIndexMatchesFullScan() {
+    const vector<string> dictionary = {
+        "кот"s, "пёс"s, "хвост"s, "ошейник"s, "белый"s, "чёрный"s,
+        "глаза"s, "скворец"s, "модный"s, "пушистый"s, "евгений"s, "ухоженный"s,
+    };
+    const vector<DocumentStatus> statuses = {
+        DocumentStatus::ACTUAL, DocumentStatus::BANNED, DocumentStatus::IRRELEVANT, DocumentStatus::ACTUAL,
+    };
+    mt19937 generator(42);
+    const auto add_document = [&](SearchServer& indexed, SearchServer& reference, int document_id) {
+        uniform_int_distribution<size_t> word_index(0, dictionary.size() - 1);
+        const int word_count = uniform_int_distribution<int>(1, 12)(generator);
+        string text;
+        for (int i = 0; i < word_count; ++i) {
+            text += dictionary[word_index(generator)] + (i % 4 == 0 ? " и "s : " "s);
+        }
+        const vector<int> ratings = {uniform_int_distribution<int>(-5, 9)(generator)};
+        const DocumentStatus status = statuses[document_id % statuses.size()];
+        indexed.AddDocument(document_id, text, status, ratings);
+        reference.AddDocument(document_id, text, status, ratings);
+    };
+
+    SearchServer indexed("и в на"s);
+    SearchServer reference("и в на"s);
+    indexed.SetImpactIndexEnabled(true);
+    for (int id = 0; id < 300; ++id) {
+        add_document(indexed, reference, id);
+    }
+    AssertImpactMatchesFullScan(indexed, reference, dictionary);
+
+    for (int id = 0; id < 300; id += 3) {
+        indexed.RemoveDocument(id);
+        reference.RemoveDocument(id);
+    }
+    for (int id = 1; id < 300; id += 5) {
+        indexed.RemoveDocument(std::execution::par, id);
+        reference.RemoveDocument(std::execution::par, id);
+    }
+    AssertImpactMatchesFullScan(indexed, reference, dictionary);
+
+    // повторно занятые id
+    for (int id = 0; id < 300; ++id) {
+        indexed.RemoveDocument(id);
+        reference.RemoveDocument(id);
+        if (id % 2 == 0) {
+            add_document(indexed, reference, id);
+        }
+    }
+    AssertImpactMatchesFullScan(indexed, reference, dictionary);
+
+    // включение на заполненном индексе строит те же списки
+    indexed.SetImpactIndexEnabled(false);
+    indexed.SetImpactIndexEnabled(true);
+    AssertImpactMatchesFullScan(indexed, reference, dictionary);
+}
+
+namespace {
+
+void AssertScorerMatchesSearchServer(const CompactScorer& scorer, const SearchServer& search_server,
+                                     const vector<string>& queries, double max_error) {
+    const auto odd_id = [](int document_id, DocumentStatus, int) {
+        return document_id % 2 == 1;
+    };
+    for (const string& query : queries) {
+        const vector<pair<vector<Document>, vector<Document>>> rankings = {
+            {scorer.FindTopDocuments(query), search_server.FindTopDocuments(query)},
+            {scorer.FindTopDocuments(query, DocumentStatus::BANNED),
+             search_server.FindTopDocuments(query, DocumentStatus::BANNED)},
+            {scorer.FindTopDocuments(query, odd_id), search_server.FindTopDocuments(query, odd_id)},
+        };
+        for (const auto& [actual, expected] : rankings) {
+            ASSERT_EQUAL_HINT(actual.size(), expected.size(), query);
+            for (size_t i = 0; i < actual.size(); ++i) {
+                ASSERT_EQUAL_HINT(actual[i].id, expected[i].id, query);
+                ASSERT_EQUAL_HINT(actual[i].rating, expected[i].rating, query);
+                ASSERT_HINT(abs(actual[i].relevance - expected[i].relevance) < max_error, query);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+// Рейтинги у всех документов разные, поэтому порядок выдачи однозначен
+// и должен совпадать с точным вплоть до id.
+void TestCompactScorerMatchesSearchServer() {
+    const vector<string> dictionary = {
+        "кот"s, "пёс"s, "хвост"s, "ошейник"s, "белый"s, "чёрный"s, "глаза"s,
+        "скворец"s, "модный"s, "пушистый"s, "евгений"s, "ухоженный"s, "выразительные"s,
+    };
+    const vector<DocumentStatus> statuses = {DocumentStatus::ACTUAL, DocumentStatus::BANNED, DocumentStatus::ACTUAL};
+    mt19937 generator(7);
+    SearchServer search_server("и в на"s);
+    for (int id = 0; id < 500; ++id) {
+        const int word_count = uniform_int_distribution<int>(1, 15)(generator);
+        string text;
+        for (int i = 0; i < word_count; ++i) {
+            text += dictionary[uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)] + " и "s;
+        }
+        search_server.AddDocument(id, text, statuses[id % statuses.size()], {id});
+    }
+    // слова, которые исчезнут из словаря вместе с документом
+    search_server.AddDocument(500, "редкое слово кот"s, DocumentStatus::ACTUAL, {500});
+    search_server.AddDocument(501, "редкое другое"s, DocumentStatus::ACTUAL, {501});
+
+    vector<string> queries;
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+        const string& next = dictionary[(i + 1) % dictionary.size()];
+        queries.push_back(dictionary[i]);
+        queries.push_back(dictionary[i] + " "s + next);
+        queries.push_back(dictionary[i] + " "s + next + " -"s + dictionary[(i + 4) % dictionary.size()]);
+    }
+    queries.push_back("редкое слово"s);
+    queries.push_back("кот -редкое"s);
+    queries.push_back("несуществующее"s);
+
+    const CompactScorer float_scorer(search_server, ScorePrecision::FLOAT);
+    const CompactScorer fixed_scorer(search_server, ScorePrecision::FIXED16);
+    AssertScorerMatchesSearchServer(float_scorer, search_server, queries, 1e-5);
+    AssertScorerMatchesSearchServer(fixed_scorer, search_server, queries, 1e-4);
+    ASSERT_EQUAL(fixed_scorer.CompareWithDoublePrecision(queries).identical_rankings, static_cast<int>(queries.size()));
+
+    // снимок не ссылается на слова сервера и после удаления отвечает как раньше
+    const auto rare_before = fixed_scorer.FindTopDocuments("редкое слово -кот"s);
+    search_server.RemoveDocument(500);
+    search_server.RemoveDocument(501);
+    ASSERT(search_server.FindTopDocuments("редкое"s).empty());
+    const auto rare_after = fixed_scorer.FindTopDocuments("редкое слово -кот"s);
+    ASSERT_EQUAL(rare_after.size(), 1u);
+    ASSERT_EQUAL(rare_after[0].id, 501);
+    ASSERT_EQUAL(rare_after[0].relevance, rare_before[0].relevance);
+}
+
+namespace {
+
+vector<int> GetIds(const vector<Document>& documents) {
+    vector<int> ids;
+    for (const Document& document : documents) {
+        ids.push_back(document.id);
+    }
+    return ids;
+}
+
+// "кот" в первых 2500 документах, "пёс" — в чётных, "ошейник" — в каждом третьем
+void AddStatusTestDocuments(SearchServer& search_server) {
+    for (int id = 0; id < 3000; ++id) {
+        string text = id < 2500 ? "кот"s : "хвост"s;
+        if (id % 2 == 0) {
+            text += " пёс"s;
+        }
+        if (id % 3 == 0) {
+            text += " ошейник"s;
+        }
+        search_server.AddDocument(id, text, DocumentStatus::ACTUAL, {id % 10});
+    }
+}
+
+}  // namespace
+
+void TestSearchStatusWithoutLimits() {
+    SearchServer search_server("и в на"s);
+    AddStatusTestDocuments(search_server);
+    const string query = "кот пёс -ошейник"s;
+    const SearchResult result = search_server.FindTopDocuments(SearchControl{}, query);
+    ASSERT(result.status == QueryStatus::OK);
+    ASSERT(GetIds(result.documents) == GetIds(search_server.FindTopDocuments(query)));
+
+    const auto results = ProcessQueries(search_server, {query, "пёс"s},
+                                        SearchControl::Clock::now() + 1h);
+    ASSERT_EQUAL(results.size(), 2u);
+    ASSERT(results[0].status == QueryStatus::OK);
+    ASSERT(GetIds(results[0].documents) == GetIds(search_server.FindTopDocuments(query)));
+    ASSERT(results[1].status == QueryStatus::OK);
+    ASSERT(GetIds(results[1].documents) == GetIds(search_server.FindTopDocuments("пёс"s)));
+
+    const SearchResult async_result = FindTopDocumentsAsync(search_server, query, SearchControl{}).get();
+    ASSERT(async_result.status == QueryStatus::OK);
+    ASSERT(GetIds(async_result.documents) == GetIds(search_server.FindTopDocuments(query)));
+}
+
+void TestSearchStatusTimeout() {
+    SearchServer search_server("и в на"s);
+    AddStatusTestDocuments(search_server);
+    SearchControl expired;
+    expired.deadline = SearchControl::Clock::now() - 1s;
+
+    const SearchResult result = search_server.FindTopDocuments(expired, "кот"s);
+    ASSERT(result.status == QueryStatus::TIMEOUT);
+    ASSERT(result.documents.empty());
+
+    const auto results = ProcessQueries(search_server, {"кот"s, "пёс"s, "ошейник"s}, expired.deadline);
+    ASSERT_EQUAL(results.size(), 3u);
+    for (const SearchResult& query_result : results) {
+        ASSERT(query_result.status == QueryStatus::TIMEOUT);
+        ASSERT(query_result.documents.empty());
+    }
+
+    const SearchResult async_result = FindTopDocumentsAsync(search_server, "кот"s, expired).get();
+    ASSERT(async_result.status == QueryStatus::TIMEOUT);
+    ASSERT(async_result.documents.empty());
+}
+
+void TestSearchStatusCancelled() {
+    SearchServer search_server("и в на"s);
+    AddStatusTestDocuments(search_server);
+    SearchControl control;
+    control.cancellation.Cancel();
+
+    const SearchResult result = search_server.FindTopDocuments(control, "кот"s);
+    ASSERT(result.status == QueryStatus::CANCELLED);
+    ASSERT(result.documents.empty());
+
+    // отмена важнее дедлайна, даже если он ещё не наступил
+    const auto results = ProcessQueries(search_server, {"кот"s, "пёс"s},
+                                        SearchControl::Clock::now() + 1h, control.cancellation);
+    ASSERT_EQUAL(results.size(), 2u);
+    for (const SearchResult& query_result : results) {
+        ASSERT(query_result.status == QueryStatus::CANCELLED);
+        ASSERT(query_result.documents.empty());
+    }
+
+    const SearchResult async_result = FindTopDocumentsAsync(search_server, "кот"s, control).get();
+    ASSERT(async_result.status == QueryStatus::CANCELLED);
+    ASSERT(async_result.documents.empty());
+}
+
+// Дедлайн наступает во время просмотра постингов первого плюс-слова:
+// поиск успевает один блок "кот" и не доходит до "пёс".
+void TestSearchStatusTruncated() {
+    SearchServer search_server("и в на"s);
+    AddStatusTestDocuments(search_server);
+    SearchControl control;
+    control.deadline = SearchControl::Clock::now() + 100ms;
+    bool slept = false;
+    const auto slow_predicate = [&control, &slept](int, DocumentStatus, int) {
+        if (!slept) {
+            this_thread::sleep_until(control.deadline + 10ms);
+            slept = true;
+        }
+        return true;
+    };
+
+    const SearchResult result = search_server.FindTopDocuments(control, "кот пёс -ошейник"s, slow_predicate);
+    ASSERT(result.status == QueryStatus::TRUNCATED);
+    ASSERT_EQUAL(result.documents.size(), SearchServer::MAX_RESULT_DOCUMENT_COUNT);
+    const double cat_only_relevance = search_server.FindTopDocuments("кот -пёс"s).front().relevance;
+    for (const Document& document : result.documents) {
+        ASSERT_HINT(document.id < static_cast<int>(QueryGuard::POSTING_BLOCK_SIZE), to_string(document.id));
+        // минус-слова применены и после остановки
+        ASSERT_HINT(document.id % 3 != 0, to_string(document.id));
+        // вклад "пёс" не учтён
+        ASSERT_HINT(abs(document.relevance - cat_only_relevance) < SearchServer::EPSILON, to_string(document.id));
+    }
+    ASSERT(result.documents.front().relevance < search_server.FindTopDocuments("кот пёс -ошейник"s).front().relevance);
+}
+
+void TestMemoryStatsFollowIndex() {
+    SearchServer search_server("и в на"s);
+    search_server.SetImpactIndexEnabled(true);
+    const MemoryStats empty = search_server.GetMemoryStats();
+    ASSERT(empty.stop_words.allocated_bytes > 0);
+    ASSERT_EQUAL(empty.documents.allocated_blocks, 0);
+    ASSERT_EQUAL(empty.inverted_index.allocated_blocks, 0);
+    ASSERT_EQUAL(empty.forward_index.allocated_blocks, 0);
+
+    for (int id = 0; id < 100; ++id) {
+        search_server.AddDocument(id, "кот и пёс "s + to_string(id), DocumentStatus::ACTUAL, {id});
+    }
+    const MemoryStats filled = search_server.GetMemoryStats();
+    ASSERT_EQUAL(filled.documents.allocated_blocks, 100);
+    ASSERT_EQUAL(filled.document_ids.allocated_blocks, 100);
+    // один блок прямого индекса на документ
+    ASSERT_EQUAL(filled.forward_index.allocated_blocks, 100);
+    ASSERT(filled.inverted_index.allocated_bytes > 0);
+    ASSERT(filled.impact_index.allocated_bytes > 0);
+    ASSERT(filled.dictionary.allocated_bytes > empty.dictionary.allocated_bytes);
+    ASSERT_EQUAL(filled.stop_words.allocated_bytes, empty.stop_words.allocated_bytes);
+    ASSERT(filled.GetAllocatedBytes() > empty.GetAllocatedBytes());
+
+    for (int id = 0; id < 100; ++id) {
+        search_server.RemoveDocument(id);
+    }
+    const MemoryStats removed = search_server.GetMemoryStats();
+    ASSERT_EQUAL(removed.documents.allocated_bytes, 0);
+    ASSERT_EQUAL(removed.document_ids.allocated_bytes, 0);
+    ASSERT_EQUAL(removed.forward_index.allocated_bytes, 0);
+    ASSERT_EQUAL(removed.inverted_index.allocated_bytes, 0);
+    ASSERT_EQUAL(removed.impact_index.allocated_bytes, 0);
+    ASSERT(removed.dictionary.allocated_bytes < filled.dictionary.allocated_bytes);
+    ASSERT(removed.GetAllocatedBytes() < filled.GetAllocatedBytes());
+}
+
+// Копия не ссылается на слова и счётчики исходного сервера.
+void TestCopyAndMove() {
+    const vector<string> queries = {"кот"s, "пёс -кот"s, "хвост ошейник"s, "слово7 кот"s};
+    optional<SearchServer> original("и в на"s);
+    original->SetImpactIndexEnabled(true);
+    for (int id = 0; id < 60; ++id) {
+        const string text = (id % 2 == 0 ? "кот хвост "s : "пёс ошейник "s) + "слово"s + to_string(id % 10);
+        original->AddDocument(id, text, DocumentStatus::ACTUAL, {id % 4});
+    }
+    // освобождённые term id должны скопироваться вместе со словарём
+    original->AddDocument(100, "редкое"s, DocumentStatus::ACTUAL, {1});
+    original->RemoveDocument(100);
+    original->RemoveDocument(7);
+
+    vector<vector<int>> expected;
+    for (const string& query : queries) {
+        expected.push_back(GetIds(original->FindTopDocuments(query)));
+    }
+    const auto expected_frequencies = original->GetWordFrequencies(8);
+    const MemoryStats original_stats = original->GetMemoryStats();
+
+    SearchServer copy(*original);
+    original->AddDocument(200, "кот кот кот"s, DocumentStatus::ACTUAL, {9});
+    ASSERT_EQUAL(copy.GetMemoryStats().documents.allocated_blocks, original_stats.documents.allocated_blocks);
+    original.reset();
+
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ASSERT_HINT(GetIds(copy.FindTopDocuments(queries[i])) == expected[i], queries[i]);
+    }
+    ASSERT_EQUAL(copy.GetWordFrequencies(8).size(), expected_frequencies.size());
+    const MemoryStats copy_stats = copy.GetMemoryStats();
+    ASSERT_EQUAL(copy_stats.documents.allocated_blocks, original_stats.documents.allocated_blocks);
+    ASSERT_EQUAL(copy_stats.inverted_index.allocated_blocks, original_stats.inverted_index.allocated_blocks);
+    ASSERT_EQUAL(copy_stats.impact_index.allocated_blocks, original_stats.impact_index.allocated_blocks);
+    copy.AddDocument(101, "новое слово"s, DocumentStatus::ACTUAL, {1});
+    ASSERT_EQUAL(copy.FindTopDocuments("новое"s).size(), 1u);
+
+    SearchServer moved(move(copy));
+    ASSERT_EQUAL(moved.FindTopDocuments("новое"s).size(), 1u);
+    ASSERT(GetIds(moved.FindTopDocuments(queries[0])) == expected[0]);
+    ASSERT_EQUAL(moved.GetMemoryStats().documents.allocated_blocks, copy_stats.documents.allocated_blocks + 1);
+
+    SearchServer assigned("на"s);
+    assigned.AddDocument(1, "старое"s, DocumentStatus::ACTUAL, {1});
+    assigned = moved;
+    ASSERT(assigned.FindTopDocuments("старое"s).empty());
+    ASSERT(GetIds(assigned.FindTopDocuments(queries[1])) == expected[1]);
+    ASSERT(assigned.FindTopDocuments("и"s).empty());
+
+    assigned = SearchServer("и"s);
+    ASSERT_EQUAL(assigned.GetDocumentCount(), 0);
+    ASSERT_EQUAL(assigned.GetMemoryStats().documents.allocated_blocks, 0);
+    ASSERT_EQUAL(moved.GetDocumentCount(), 60);
+}
+
+namespace {
+
+void AssertSameFrequencies(const SearchServer& actual, const SearchServer& expected, int document_id) {
+    const auto actual_freqs = actual.GetWordFrequencies(document_id);
+    const auto expected_freqs = expected.GetWordFrequencies(document_id);
+    ASSERT_EQUAL_HINT(actual_freqs.size(), expected_freqs.size(), to_string(document_id));
+    for (const auto& [word, freq] : expected_freqs) {
+        const auto actual_freq = actual_freqs.find(word);
+        ASSERT_HINT(actual_freq != actual_freqs.end(), string(word));
+        ASSERT_HINT(abs(actual_freq->second - freq) < 1e-12, string(word));
+    }
+}
+
+}  // namespace
+
+// Без прямого индекса частоты и удаление берутся из обратного,
+// результат должен совпадать с режимом COMPACT.
+void TestForwardIndexModes() {
+    const vector<string> dictionary = {
+        "кот"s, "пёс"s, "хвост"s, "ошейник"s, "белый"s, "чёрный"s, "глаза"s, "скворец"s,
+    };
+    SearchServer compact("и в на"s);
+    SearchServer disabled("и в на"s);
+    disabled.SetForwardIndexMode(ForwardIndexMode::DISABLED);
+    ASSERT(compact.GetForwardIndexMode() == ForwardIndexMode::COMPACT);
+    ASSERT(disabled.GetForwardIndexMode() == ForwardIndexMode::DISABLED);
+
+    mt19937 generator(11);
+    for (int id = 0; id < 200; ++id) {
+        const int word_count = uniform_int_distribution<int>(1, 10)(generator);
+        string text;
+        for (int i = 0; i < word_count; ++i) {
+            text += dictionary[uniform_int_distribution<size_t>(0, dictionary.size() - 1)(generator)] + " и "s;
+        }
+        compact.AddDocument(id, text, DocumentStatus::ACTUAL, {id % 5});
+        disabled.AddDocument(id, text, DocumentStatus::ACTUAL, {id % 5});
+    }
+    ASSERT_THROWS(compact.SetForwardIndexMode(ForwardIndexMode::DISABLED), logic_error);
+    ASSERT_EQUAL(compact.GetMemoryStats().forward_index.allocated_blocks, 200);
+    ASSERT_EQUAL(disabled.GetMemoryStats().forward_index.allocated_bytes, 0);
+    for (int id = 0; id < 200; ++id) {
+        AssertSameFrequencies(disabled, compact, id);
+    }
+    ASSERT(compact.GetWordFrequencies(1000).empty());
+    ASSERT(disabled.GetWordFrequencies(1000).empty());
+
+    for (int id = 0; id < 200; id += 3) {
+        compact.RemoveDocument(id);
+        disabled.RemoveDocument(id);
+    }
+    for (int id = 1; id < 200; id += 7) {
+        compact.RemoveDocument(std::execution::par, id);
+        disabled.RemoveDocument(std::execution::par, id);
+    }
+    ASSERT_EQUAL(disabled.GetDocumentCount(), compact.GetDocumentCount());
+    for (int id = 0; id < 200; ++id) {
+        AssertSameFrequencies(disabled, compact, id);
+    }
+    for (const string& word : dictionary) {
+        ASSERT_HINT(GetIds(disabled.FindTopDocuments(word)) == GetIds(compact.FindTopDocuments(word)), word);
+    }
+    ASSERT(disabled.GetWordFrequencies(0).empty());
+    ASSERT(disabled.FindTopDocuments("кот"s, [](int document_id, DocumentStatus, int) {
+        return document_id % 3 == 0;
+    }).empty());
+}
+
+// Слова удалённых документов уходят из словаря, их term id достаются новым словам:
+// словарь не растёт, а прямой индекс не ссылается на прежние слова.
+void TestTermIdReuse() {
+    for (const ForwardIndexMode mode : {ForwardIndexMode::COMPACT, ForwardIndexMode::DISABLED}) {
+        SearchServer search_server("и в на"s);
+        search_server.SetForwardIndexMode(mode);
+        search_server.AddDocument(1000, "постоянное"s, DocumentStatus::ACTUAL, {1});
+
+        int64_t dictionary_bytes = 0;
+        for (int round = 0; round < 20; ++round) {
+            string text;
+            for (int i = 0; i < 100; ++i) {
+                text += "слово"s + to_string(round) + "_"s + to_string(i) + (i % 2 == 0 ? " общее "s : " "s);
+            }
+            search_server.AddDocument(round, text, DocumentStatus::ACTUAL, {round});
+
+            const auto frequencies = search_server.GetWordFrequencies(round);
+            ASSERT_EQUAL(frequencies.size(), 101u);
+            ASSERT(frequencies.count("слово"s + to_string(round) + "_99"s) > 0);
+            ASSERT(round == 0 || frequencies.count("слово"s + to_string(round - 1) + "_99"s) == 0);
+            ASSERT_EQUAL(search_server.FindTopDocuments("слово"s + to_string(round) + "_0"s).at(0).id, round);
+            if (round > 0) {
+                ASSERT(search_server.FindTopDocuments("слово"s + to_string(round - 1) + "_0"s).empty());
+            }
+
+            search_server.RemoveDocument(round);
+            const MemoryStats stats = search_server.GetMemoryStats();
+            ASSERT_EQUAL(stats.dictionary.entries, 1u);
+            if (round == 1) {
+                dictionary_bytes = stats.dictionary.allocated_bytes;
+            } else if (round > 1) {
+                ASSERT_EQUAL(stats.dictionary.allocated_bytes, dictionary_bytes);
+            }
+        }
+        ASSERT_EQUAL(search_server.FindTopDocuments("постоянное"s).at(0).id, 1000);
+        ASSERT_EQUAL(search_server.GetWordFrequencies(1000).size(), 1u);
+    }
+}
+
+int main() {
+    RUN_TEST(TestCursorPaginationTerminates);
+    RUN_TEST(TestImpactIndexMatchesFullScan);
+    RUN_TEST(TestCompactScorerMatchesSearchServer);
+    RUN_TEST(TestSearchStatusWithoutLimits);
+    RUN_TEST(TestSearchStatusTimeout);
+    RUN_TEST(TestSearchStatusCancelled);
+    RUN_TEST(TestSearchStatusTruncated);
+    RUN_TEST(TestMemoryStatsFollowIndex);
+    RUN_TEST(TestCopyAndMove);
+    RUN_TEST(TestForwardIndexModes);
+    RUN_TEST(TestTermIdReuse);
+}
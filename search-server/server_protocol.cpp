@@ -0,0 +1,340 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "server_protocol.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+class FrameWriter {
+public:
+    explicit FrameWriter(std::string& out) : out_(out), start_(out.size()) {
+        PutU32(0);
+    }
+
+    ~FrameWriter() {
+        const uint32_t payload_size = static_cast<uint32_t>(out_.size() - start_ - FRAME_HEADER_SIZE);
+        for (size_t i = 0; i < FRAME_HEADER_SIZE; ++i) {
+            out_[start_ + i] = static_cast<char>((payload_size >> (8 * (FRAME_HEADER_SIZE - 1 - i))) & 0xFF);
+        }
+    }
+
+    void PutU8(uint8_t value) {
+        out_.push_back(static_cast<char>(value));
+    }
+
+    void PutU32(uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out_.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    void PutI32(int value) {
+        PutU32(static_cast<uint32_t>(value));
+    }
+
+    void PutDouble(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        PutU32(static_cast<uint32_t>(bits >> 32));
+        PutU32(static_cast<uint32_t>(bits));
+    }
+
+    void PutString(std::string_view value) {
+        PutU32(static_cast<uint32_t>(value.size()));
+        out_.append(value);
+    }
+
+    void PutStatistics(const CorpusStatistics& statistics) {
+        PutI32(statistics.document_count);
+        PutU32(static_cast<uint32_t>(statistics.document_freqs.size()));
+        for (const auto& [word, document_freq] : statistics.document_freqs) {
+            PutString(word);
+            PutI32(document_freq);
+        }
+    }
+
+private:
+    std::string& out_;
+    const size_t start_;
+};
+
+class FrameReader {
+public:
+    explicit FrameReader(std::string_view frame) : data_(frame) {
+        const auto frame_size = GetFrameSize(frame);
+        if (!frame_size || *frame_size != frame.size()) {
+            throw std::invalid_argument("Incomplete frame"s);
+        }
+        data_.remove_prefix(FRAME_HEADER_SIZE);
+    }
+
+    uint8_t GetU8() {
+        Require(1);
+        const uint8_t value = static_cast<uint8_t>(data_[0]);
+        data_.remove_prefix(1);
+        return value;
+    }
+
+    uint32_t GetU32() {
+        Require(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value = (value << 8) | static_cast<uint8_t>(data_[i]);
+        }
+        data_.remove_prefix(4);
+        return value;
+    }
+
+    int GetI32() {
+        return static_cast<int>(GetU32());
+    }
+
+    double GetDouble() {
+        const uint64_t high = GetU32();
+        const uint64_t bits = (high << 32) | GetU32();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string GetString() {
+        const uint32_t size = GetU32();
+        Require(size);
+        std::string value(data_.substr(0, size));
+        data_.remove_prefix(size);
+        return value;
+    }
+
+    CorpusStatistics GetStatistics() {
+        CorpusStatistics statistics;
+        statistics.document_count = GetI32();
+        const uint32_t count = GetU32();
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string word = GetString();
+            statistics.document_freqs[std::move(word)] = GetI32();
+        }
+        return statistics;
+    }
+
+    DocumentStatus GetStatus() {
+        const uint8_t status = GetU8();
+        if (status > static_cast<uint8_t>(DocumentStatus::REMOVED)) {
+            throw std::invalid_argument("Unknown document status"s);
+        }
+        return static_cast<DocumentStatus>(status);
+    }
+
+    RequestType GetType() {
+        const uint8_t type = GetU8();
+        if (type < static_cast<uint8_t>(RequestType::FIND_TOP_DOCUMENTS)
+            || type > static_cast<uint8_t>(RequestType::FIND_TOP_DOCUMENTS_GLOBAL)) {
+            throw std::invalid_argument("Unknown request type"s);
+        }
+        return static_cast<RequestType>(type);
+    }
+
+    void ExpectEnd() const {
+        if (!data_.empty()) {
+            throw std::invalid_argument("Trailing bytes in frame"s);
+        }
+    }
+
+private:
+    std::string_view data_;
+
+    void Require(size_t size) const {
+        if (data_.size() < size) {
+            throw std::invalid_argument("Truncated frame"s);
+        }
+    }
+};
+
+}  // namespace
+
+std::optional<size_t> GetFrameSize(std::string_view buffer) {
+    if (buffer.size() < FRAME_HEADER_SIZE) {
+        return std::nullopt;
+    }
+    size_t payload_size = 0;
+    for (size_t i = 0; i < FRAME_HEADER_SIZE; ++i) {
+        payload_size = (payload_size << 8) | static_cast<uint8_t>(buffer[i]);
+    }
+    if (payload_size > MAX_FRAME_SIZE) {
+        throw std::length_error("Frame is too large"s);
+    }
+    if (buffer.size() < FRAME_HEADER_SIZE + payload_size) {
+        return std::nullopt;
+    }
+    return FRAME_HEADER_SIZE + payload_size;
+}
+
+void AppendRequestFrame(std::string& out, const Request& request) {
+    FrameWriter writer(out);
+    writer.PutU32(request.request_id);
+    writer.PutU8(static_cast<uint8_t>(request.type));
+    switch (request.type) {
+        case RequestType::FIND_TOP_DOCUMENTS:
+            writer.PutU8(static_cast<uint8_t>(request.status));
+            writer.PutString(request.text);
+            break;
+        case RequestType::MATCH_DOCUMENT:
+            writer.PutI32(request.document_id);
+            writer.PutString(request.text);
+            break;
+        case RequestType::ADD_DOCUMENT:
+            writer.PutI32(request.document_id);
+            writer.PutU8(static_cast<uint8_t>(request.status));
+            writer.PutU32(static_cast<uint32_t>(request.ratings.size()));
+            for (const int rating : request.ratings) {
+                writer.PutI32(rating);
+            }
+            writer.PutString(request.text);
+            break;
+        case RequestType::REMOVE_DOCUMENT:
+            writer.PutI32(request.document_id);
+            break;
+        case RequestType::GET_CORPUS_STATISTICS:
+            writer.PutString(request.text);
+            break;
+        case RequestType::FIND_TOP_DOCUMENTS_GLOBAL:
+            writer.PutU8(static_cast<uint8_t>(request.status));
+            writer.PutString(request.text);
+            writer.PutStatistics(request.statistics);
+            break;
+    }
+}
+
+void AppendResponseFrame(std::string& out, const Response& response) {
+    FrameWriter writer(out);
+    writer.PutU32(response.request_id);
+    writer.PutU8(static_cast<uint8_t>(response.type));
+    writer.PutU8(static_cast<uint8_t>(response.status));
+    if (response.status != ResponseStatus::OK) {
+        writer.PutString(response.error);
+        return;
+    }
+    switch (response.type) {
+        case RequestType::FIND_TOP_DOCUMENTS:
+        case RequestType::FIND_TOP_DOCUMENTS_GLOBAL:
+            writer.PutU32(static_cast<uint32_t>(response.documents.size()));
+            for (const Document& document : response.documents) {
+                writer.PutI32(document.id);
+                writer.PutDouble(document.relevance);
+                writer.PutI32(document.rating);
+            }
+            break;
+        case RequestType::MATCH_DOCUMENT:
+            writer.PutU8(static_cast<uint8_t>(response.document_status));
+            writer.PutU32(static_cast<uint32_t>(response.matched_words.size()));
+            for (const std::string& word : response.matched_words) {
+                writer.PutString(word);
+            }
+            break;
+        case RequestType::GET_CORPUS_STATISTICS:
+            writer.PutStatistics(response.statistics);
+            break;
+        case RequestType::ADD_DOCUMENT:
+        case RequestType::REMOVE_DOCUMENT:
+            break;
+    }
+}
+
+Request ParseRequestFrame(std::string_view frame) {
+    FrameReader reader(frame);
+    Request request;
+    request.request_id = reader.GetU32();
+    request.type = reader.GetType();
+    switch (request.type) {
+        case RequestType::FIND_TOP_DOCUMENTS:
+            request.status = reader.GetStatus();
+            request.text = reader.GetString();
+            break;
+        case RequestType::MATCH_DOCUMENT:
+            request.document_id = reader.GetI32();
+            request.text = reader.GetString();
+            break;
+        case RequestType::ADD_DOCUMENT: {
+            request.document_id = reader.GetI32();
+            request.status = reader.GetStatus();
+            const uint32_t rating_count = reader.GetU32();
+            if (rating_count > frame.size() / sizeof(uint32_t)) {
+                throw std::invalid_argument("Truncated frame"s);
+            }
+            request.ratings.resize(rating_count);
+            for (int& rating : request.ratings) {
+                rating = reader.GetI32();
+            }
+            request.text = reader.GetString();
+            break;
+        }
+        case RequestType::REMOVE_DOCUMENT:
+            request.document_id = reader.GetI32();
+            break;
+        case RequestType::GET_CORPUS_STATISTICS:
+            request.text = reader.GetString();
+            break;
+        case RequestType::FIND_TOP_DOCUMENTS_GLOBAL:
+            request.status = reader.GetStatus();
+            request.text = reader.GetString();
+            request.statistics = reader.GetStatistics();
+            break;
+    }
+    reader.ExpectEnd();
+    return request;
+}
+
+Response ParseResponseFrame(std::string_view frame) {
+    FrameReader reader(frame);
+    Response response;
+    response.request_id = reader.GetU32();
+    response.type = reader.GetType();
+    const uint8_t status = reader.GetU8();
+    if (status > static_cast<uint8_t>(ResponseStatus::INTERNAL_ERROR)) {
+        throw std::invalid_argument("Unknown response status"s);
+    }
+    response.status = static_cast<ResponseStatus>(status);
+    if (response.status != ResponseStatus::OK) {
+        response.error = reader.GetString();
+        reader.ExpectEnd();
+        return response;
+    }
+    switch (response.type) {
+        case RequestType::FIND_TOP_DOCUMENTS:
+        case RequestType::FIND_TOP_DOCUMENTS_GLOBAL: {
+            const uint32_t count = reader.GetU32();
+            if (count > frame.size()) {
+                throw std::invalid_argument("Truncated frame"s);
+            }
+            response.documents.reserve(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                const int id = reader.GetI32();
+                const double relevance = reader.GetDouble();
+                const int rating = reader.GetI32();
+                response.documents.emplace_back(id, relevance, rating);
+            }
+            break;
+        }
+        case RequestType::MATCH_DOCUMENT: {
+            response.document_status = reader.GetStatus();
+            const uint32_t count = reader.GetU32();
+            if (count > frame.size()) {
+                throw std::invalid_argument("Truncated frame"s);
+            }
+            response.matched_words.reserve(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                response.matched_words.push_back(reader.GetString());
+            }
+            break;
+        }
+        case RequestType::GET_CORPUS_STATISTICS:
+            response.statistics = reader.GetStatistics();
+            break;
+        case RequestType::ADD_DOCUMENT:
+        case RequestType::REMOVE_DOCUMENT:
+            break;
+    }
+    reader.ExpectEnd();
+    return response;
+}
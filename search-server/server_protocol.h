@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "document.h"
+
+// Кадр: 4 байта длины (big-endian) и полезная нагрузка.
+// Запрос:  request_id:u32 type:u8 поля типа
+// Ответ:   request_id:u32 type:u8 status:u8 поля типа или текст ошибки
+// Строки кодируются как длина:u32 и байты, числа — big-endian.
+
+enum class RequestType : uint8_t {
+    FIND_TOP_DOCUMENTS = 1,
+    MATCH_DOCUMENT = 2,
+    ADD_DOCUMENT = 3,
+    REMOVE_DOCUMENT = 4,
+    GET_CORPUS_STATISTICS = 5,
+    FIND_TOP_DOCUMENTS_GLOBAL = 6,
+};
+
+enum class ResponseStatus : uint8_t {
+    OK = 0,
+    INVALID_ARGUMENT = 1,
+    OUT_OF_RANGE = 2,
+    BAD_REQUEST = 3,
+    INTERNAL_ERROR = 4,  // непредвиденное исключение при выполнении запроса
+};
+
+struct Request {
+    uint32_t request_id = 0;
+    RequestType type = RequestType::FIND_TOP_DOCUMENTS;
+    int document_id = 0;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+    std::string text;
+    CorpusStatistics statistics;
+};
+
+struct Response {
+    uint32_t request_id = 0;
+    RequestType type = RequestType::FIND_TOP_DOCUMENTS;
+    ResponseStatus status = ResponseStatus::OK;
+    std::vector<Document> documents;
+    std::vector<std::string> matched_words;
+    DocumentStatus document_status = DocumentStatus::ACTUAL;
+    CorpusStatistics statistics;
+    std::string error;
+};
+
+constexpr size_t FRAME_HEADER_SIZE = 4;
+constexpr size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+// Размер первого кадра в буфере вместе с заголовком или nullopt, если кадр ещё не дочитан.
+// Бросает std::length_error, если объявленная длина больше MAX_FRAME_SIZE.
+std::optional<size_t> GetFrameSize(std::string_view buffer);
+
+void AppendRequestFrame(std::string& out, const Request& request);
+void AppendResponseFrame(std::string& out, const Response& response);
+
+// Принимают кадр целиком, бросают std::invalid_argument на некорректных данных.
+Request ParseRequestFrame(std::string_view frame);
+Response ParseResponseFrame(std::string_view frame);
@@ -0,0 +1,168 @@
+#include <stdexcept>
+#include <string>
+
+#include "server_protocol.h"
+#include "test_framework.h"
+
+using namespace std;
+
+namespace {
+
+string MakeFrame(string_view payload) {
+    string frame;
+    const uint32_t size = static_cast<uint32_t>(payload.size());
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        frame.push_back(static_cast<char>((size >> shift) & 0xFF));
+    }
+    frame.append(payload);
+    return frame;
+}
+
+Request RoundTrip(const Request& request) {
+    string frame;
+    AppendRequestFrame(frame, request);
+    ASSERT_EQUAL(GetFrameSize(frame).value_or(0), frame.size());
+    return ParseRequestFrame(frame);
+}
+
+Response RoundTrip(const Response& response) {
+    string frame;
+    AppendResponseFrame(frame, response);
+    ASSERT_EQUAL(GetFrameSize(frame).value_or(0), frame.size());
+    return ParseResponseFrame(frame);
+}
+
+}  // namespace
+
+void TestFrameSize() {
+    string buffer;
+    Request request;
+    request.request_id = 7;
+    request.text = "белый кот"s;
+    AppendRequestFrame(buffer, request);
+    const size_t first_size = buffer.size();
+    AppendRequestFrame(buffer, request);
+
+    ASSERT(!GetFrameSize(string_view(buffer).substr(0, FRAME_HEADER_SIZE - 1)));
+    ASSERT(!GetFrameSize(string_view(buffer).substr(0, first_size - 1)));
+    ASSERT_EQUAL(GetFrameSize(buffer).value_or(0), first_size);
+    ASSERT_EQUAL(GetFrameSize(string_view(buffer).substr(first_size)).value_or(0), first_size);
+
+    const string too_large = "\x04\x00\x00\x01"s;
+    ASSERT_THROWS(GetFrameSize(too_large), length_error);
+}
+
+void TestRequestRoundTrip() {
+    Request find;
+    find.request_id = 0xDEADBEEF;
+    find.type = RequestType::FIND_TOP_DOCUMENTS;
+    find.status = DocumentStatus::BANNED;
+    find.text = "кот -пёс"s;
+    const Request parsed_find = RoundTrip(find);
+    ASSERT_EQUAL(parsed_find.request_id, find.request_id);
+    ASSERT(parsed_find.type == RequestType::FIND_TOP_DOCUMENTS);
+    ASSERT(parsed_find.status == DocumentStatus::BANNED);
+    ASSERT_EQUAL(parsed_find.text, find.text);
+
+    Request add;
+    add.type = RequestType::ADD_DOCUMENT;
+    add.document_id = -5;
+    add.status = DocumentStatus::IRRELEVANT;
+    add.ratings = {1, -2, 2147483647};
+    add.text = string("с\0нулём"s);
+    const Request parsed_add = RoundTrip(add);
+    ASSERT(parsed_add.type == RequestType::ADD_DOCUMENT);
+    ASSERT_EQUAL(parsed_add.document_id, -5);
+    ASSERT(parsed_add.status == DocumentStatus::IRRELEVANT);
+    ASSERT(parsed_add.ratings == add.ratings);
+    ASSERT_EQUAL(parsed_add.text, add.text);
+
+    Request remove;
+    remove.type = RequestType::REMOVE_DOCUMENT;
+    remove.document_id = 42;
+    ASSERT_EQUAL(RoundTrip(remove).document_id, 42);
+
+    Request global;
+    global.type = RequestType::FIND_TOP_DOCUMENTS_GLOBAL;
+    global.text = "кот"s;
+    global.statistics.document_count = 10;
+    global.statistics.document_freqs = {{"кот"s, 3}, {"пёс"s, 0}};
+    const Request parsed_global = RoundTrip(global);
+    ASSERT_EQUAL(parsed_global.statistics.document_count, 10);
+    ASSERT(parsed_global.statistics.document_freqs == global.statistics.document_freqs);
+}
+
+void TestResponseRoundTrip() {
+    Response found;
+    found.request_id = 3;
+    found.type = RequestType::FIND_TOP_DOCUMENTS;
+    found.documents = {{1, 0.25, 5}, {2, -0.0, -1}};
+    const Response parsed_found = RoundTrip(found);
+    ASSERT_EQUAL(parsed_found.documents.size(), 2u);
+    ASSERT_EQUAL(parsed_found.documents[0].id, 1);
+    ASSERT_EQUAL(parsed_found.documents[0].relevance, 0.25);
+    ASSERT_EQUAL(parsed_found.documents[1].rating, -1);
+
+    Response matched;
+    matched.type = RequestType::MATCH_DOCUMENT;
+    matched.document_status = DocumentStatus::REMOVED;
+    matched.matched_words = {"кот"s, "хвост"s};
+    const Response parsed_matched = RoundTrip(matched);
+    ASSERT(parsed_matched.document_status == DocumentStatus::REMOVED);
+    ASSERT(parsed_matched.matched_words == matched.matched_words);
+
+    Response error;
+    error.type = RequestType::ADD_DOCUMENT;
+    error.status = ResponseStatus::INVALID_ARGUMENT;
+    error.error = "Invalid document_id"s;
+    const Response parsed_error = RoundTrip(error);
+    ASSERT(parsed_error.status == ResponseStatus::INVALID_ARGUMENT);
+    ASSERT_EQUAL(parsed_error.error, error.error);
+
+    error.status = ResponseStatus::INTERNAL_ERROR;
+    error.error = "std::bad_alloc"s;
+    const Response parsed_internal = RoundTrip(error);
+    ASSERT(parsed_internal.status == ResponseStatus::INTERNAL_ERROR);
+    ASSERT_EQUAL(parsed_internal.error, error.error);
+}
+
+void TestMalformedFrames() {
+    Request request;
+    request.text = "кот"s;
+    string frame;
+    AppendRequestFrame(frame, request);
+    const string payload = frame.substr(FRAME_HEADER_SIZE);
+
+    // кадр должен быть передан целиком
+    ASSERT_THROWS(ParseRequestFrame(string_view(frame).substr(0, frame.size() - 1)), invalid_argument);
+    // длина строки больше оставшихся байт
+    ASSERT_THROWS(ParseRequestFrame(MakeFrame(payload.substr(0, payload.size() - 1))), invalid_argument);
+    ASSERT_THROWS(ParseRequestFrame(MakeFrame(payload + "x"s)), invalid_argument);
+
+    string unknown_type = payload;
+    unknown_type[4] = 0;
+    ASSERT_THROWS(ParseRequestFrame(MakeFrame(unknown_type)), invalid_argument);
+    unknown_type[4] = 100;
+    ASSERT_THROWS(ParseRequestFrame(MakeFrame(unknown_type)), invalid_argument);
+
+    string unknown_status = payload;
+    unknown_status[5] = 4;
+    ASSERT_THROWS(ParseRequestFrame(MakeFrame(unknown_status)), invalid_argument);
+
+    // огромное число оценок не должно приводить к выделению памяти под них
+    const string huge_ratings = "\x00\x00\x00\x01\x03\x00\x00\x00\x01\x00\xFF\xFF\xFF\xFF"s;
+    ASSERT_THROWS(ParseRequestFrame(MakeFrame(huge_ratings)), invalid_argument);
+
+    string bad_response_status;
+    Response response;
+    AppendResponseFrame(bad_response_status, response);
+    bad_response_status[FRAME_HEADER_SIZE + 5] = 9;
+    ASSERT_THROWS(ParseResponseFrame(bad_response_status), invalid_argument);
+}
+
+int main() {
+    RUN_TEST(TestFrameSize);
+    RUN_TEST(TestRequestRoundTrip);
+    RUN_TEST(TestResponseRoundTrip);
+    RUN_TEST(TestMalformedFrames);
+}
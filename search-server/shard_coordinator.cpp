@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "shard_coordinator.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+void ThrowIfFailed(const Response& response) {
+    switch (response.status) {
+        case ResponseStatus::OK:
+            return;
+        case ResponseStatus::INVALID_ARGUMENT:
+        case ResponseStatus::BAD_REQUEST:
+            throw std::invalid_argument(response.error);
+        case ResponseStatus::OUT_OF_RANGE:
+            throw std::out_of_range(response.error);
+        case ResponseStatus::INTERNAL_ERROR:
+            throw std::runtime_error(response.error);
+    }
+}
+
+uint64_t MixDocumentId(int document_id) {
+    uint64_t x = static_cast<uint32_t>(document_id);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+}  // namespace
+
+ShardCoordinator::ShardCoordinator(const std::vector<std::string>& shard_endpoints,
+                                   ShardingScheme scheme,
+                                   int range_size)
+    : scheme_(scheme)
+    , range_size_(range_size) {
+    if (shard_endpoints.empty()) {
+        throw std::invalid_argument("At least one shard is required"s);
+    }
+    if (scheme_ == ShardingScheme::RANGE && range_size_ <= 0) {
+        throw std::invalid_argument("Range sharding requires a positive range size"s);
+    }
+    shards_.reserve(shard_endpoints.size());
+    for (const std::string& endpoint : shard_endpoints) {
+        shards_.emplace_back(endpoint);
+    }
+}
+
+void ShardCoordinator::AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    if (document_id < 0) {
+        throw std::invalid_argument("Invalid document_id"s);
+    }
+    Request request;
+    request.type = RequestType::ADD_DOCUMENT;
+    request.document_id = document_id;
+    request.status = status;
+    request.ratings = ratings;
+    request.text = std::string(document);
+    ThrowIfFailed(CallShard(GetShardIndex(document_id), std::move(request)));
+}
+
+void ShardCoordinator::RemoveDocument(int document_id) {
+    if (document_id < 0) {
+        return;
+    }
+    Request request;
+    request.type = RequestType::REMOVE_DOCUMENT;
+    request.document_id = document_id;
+    ThrowIfFailed(CallShard(GetShardIndex(document_id), std::move(request)));
+}
+
+std::vector<Document> ShardCoordinator::FindTopDocuments(std::string_view raw_query, DocumentStatus status) {
+    Request request;
+    request.type = RequestType::FIND_TOP_DOCUMENTS_GLOBAL;
+    request.status = status;
+    request.text = std::string(raw_query);
+    request.statistics = GetCorpusStatistics(raw_query);
+
+    std::vector<Document> matched_documents;
+    for (const Response& response : Broadcast(request)) {
+        ThrowIfFailed(response);
+        matched_documents.insert(matched_documents.end(), response.documents.begin(), response.documents.end());
+    }
+
+    std::sort(matched_documents.begin(), matched_documents.end(), SearchServer::IsMoreRelevant);
+    if (matched_documents.size() > SearchServer::MAX_RESULT_DOCUMENT_COUNT) {
+        matched_documents.resize(SearchServer::MAX_RESULT_DOCUMENT_COUNT);
+    }
+    return matched_documents;
+}
+
+ShardMatchTuple ShardCoordinator::MatchDocument(std::string_view raw_query, int document_id) {
+    if (document_id < 0) {
+        throw std::out_of_range("Invalid document_id"s);
+    }
+    Request request;
+    request.type = RequestType::MATCH_DOCUMENT;
+    request.document_id = document_id;
+    request.text = std::string(raw_query);
+    Response response = CallShard(GetShardIndex(document_id), std::move(request));
+    ThrowIfFailed(response);
+    return {std::move(response.matched_words), response.document_status};
+}
+
+CorpusStatistics ShardCoordinator::GetCorpusStatistics(std::string_view raw_query) {
+    Request request;
+    request.type = RequestType::GET_CORPUS_STATISTICS;
+    request.text = std::string(raw_query);
+
+    CorpusStatistics statistics;
+    for (const Response& response : Broadcast(request)) {
+        ThrowIfFailed(response);
+        statistics.document_count += response.statistics.document_count;
+        for (const auto& [word, document_freq] : response.statistics.document_freqs) {
+            statistics.document_freqs[word] += document_freq;
+        }
+    }
+    return statistics;
+}
+
+size_t ShardCoordinator::GetShardCount() const {
+    return shards_.size();
+}
+
+size_t ShardCoordinator::GetShardIndex(int document_id) const {
+    if (scheme_ == ShardingScheme::RANGE) {
+        return std::min(static_cast<size_t>(document_id / range_size_), shards_.size() - 1);
+    }
+    return MixDocumentId(document_id) % shards_.size();
+}
+
+Response ShardCoordinator::CallShard(size_t shard_index, Request request) {
+    request.request_id = next_request_id_++;
+    return shards_[shard_index].Call(request);
+}
+
+std::vector<Response> ShardCoordinator::Broadcast(const Request& request) {
+    Request numbered = request;
+    numbered.request_id = next_request_id_++;
+    for (SearchClient& shard : shards_) {
+        shard.Send(numbered);
+    }
+    std::vector<Response> responses;
+    responses.reserve(shards_.size());
+    for (SearchClient& shard : shards_) {
+        responses.push_back(shard.Receive());
+    }
+    return responses;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "document.h"
+#include "search_client.h"
+#include "search_server.h"
+
+enum class ShardingScheme {
+    HASH,
+    RANGE,
+};
+
+using ShardMatchTuple = std::tuple<std::vector<std::string>, DocumentStatus>;
+
+// Распределяет документы по процессам SearchDaemon и собирает ответы.
+// Запрос выполняется в два прохода: сначала со всех шардов собираются
+// документные частоты слов запроса, затем каждый шард ищет с глобальным IDF,
+// и их top-K сливаются в том же порядке, что и в SearchServer::FindTopDocuments.
+// Не потокобезопасен: на каждом шарде одно соединение.
+class ShardCoordinator {
+public:
+    // При RANGE шард i хранит id из [i * range_size, (i + 1) * range_size),
+    // последний шард — все id дальше.
+    explicit ShardCoordinator(const std::vector<std::string>& shard_endpoints,
+                              ShardingScheme scheme = ShardingScheme::HASH,
+                              int range_size = 0);
+
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+    void RemoveDocument(int document_id);
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+                                           DocumentStatus status = DocumentStatus::ACTUAL);
+    ShardMatchTuple MatchDocument(std::string_view raw_query, int document_id);
+    CorpusStatistics GetCorpusStatistics(std::string_view raw_query);
+
+    size_t GetShardCount() const;
+    size_t GetShardIndex(int document_id) const;
+
+private:
+    std::vector<SearchClient> shards_;
+    const ShardingScheme scheme_;
+    const int range_size_;
+    uint32_t next_request_id_ = 0;
+
+    Response CallShard(size_t shard_index, Request request);
+    std::vector<Response> Broadcast(const Request& request);
+};
@@ -0,0 +1,216 @@
+#include "shard_coordinator.h"
+#include "search_daemon.h"
+#include "search_server.h"
+#include "query_generator.h"
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+ 
+using namespace std;
+ 
+namespace {
+ 
+SearchDaemon* shard_to_stop = nullptr;
+ 
+void HandleStopSignal(int) {
+    if (shard_to_stop != nullptr) {
+        shard_to_stop->Stop();
+    }
+}
+ 
+void PrintUsage() {
+    cerr << "Usage: shard_coordinator (--spawn N | --shards EP1,EP2,...)\n"
+            "                         [--scheme hash|range] [--range-size N]\n"
+            "                         [--documents N] [--queries N] [--dictionary-size N]\n"
+            "                         [--stop-words \"WORDS\"] [--seed N]\n"
+            "Loads a synthetic corpus through the coordinator and into a single local\n"
+            "SearchServer, then checks that both return the same rankings.\n"s;
+}
+ 
+[[noreturn]] void RunShard(const string& path, const string& stop_words) {
+    try {
+        SearchServer search_server(stop_words);
+        SearchDaemon daemon(search_server, 2);
+        daemon.ListenUnix(path);
+        shard_to_stop = &daemon;
+        signal(SIGTERM, HandleStopSignal);
+        daemon.Run();
+        shard_to_stop = nullptr;
+    } catch (const exception& e) {
+        cerr << "shard "s << path << ": "s << e.what() << endl;
+        _exit(1);
+    }
+    _exit(0);
+}
+ 
+ShardCoordinator ConnectWithRetry(const vector<string>& endpoints, ShardingScheme scheme, int range_size) {
+    for (int attempt = 0;; ++attempt) {
+        try {
+            return ShardCoordinator(endpoints, scheme, range_size);
+        } catch (const system_error&) {
+            if (attempt == 100) {
+                throw;
+            }
+            this_thread::sleep_for(50ms);
+        }
+    }
+}
+ 
+bool SameRanking(const vector<Document>& expected, const vector<Document>& actual) {
+    if (expected.size() != actual.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (expected[i].id != actual[i].id
+            || abs(expected[i].relevance - actual[i].relevance) >= SearchServer::EPSILON
+            || expected[i].rating != actual[i].rating) {
+            return false;
+        }
+    }
+    return true;
+}
+ 
+int CompareRankings(const SearchServer& reference, ShardCoordinator& coordinator, const vector<string>& queries) {
+    int mismatches = 0;
+    for (const string& query : queries) {
+        const auto expected = reference.FindTopDocuments(query);
+        const auto actual = coordinator.FindTopDocuments(query);
+        if (!SameRanking(expected, actual)) {
+            ++mismatches;
+            cerr << "Mismatch for query \""s << query << "\""s << endl;
+        }
+    }
+    return mismatches;
+}
+ 
+}  // namespace
+ 
+int main(int argc, char* argv[]) {
+    int spawn_count = 0;
+    vector<string> endpoints;
+    ShardingScheme scheme = ShardingScheme::HASH;
+    int range_size = 0;
+    int document_count = 10'000;
+    int query_count = 200;
+    int dictionary_size = 1000;
+    string stop_words;
+    unsigned seed = mt19937::default_seed;
+ 
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+        const string value = argv[++i];
+        if (arg == "--spawn"s) {
+            spawn_count = stoi(value);
+        } else if (arg == "--shards"s) {
+            istringstream endpoint_list(value);
+            for (string endpoint; getline(endpoint_list, endpoint, ',');) {
+                endpoints.push_back(endpoint);
+            }
+        } else if (arg == "--scheme"s) {
+            scheme = value == "range"s ? ShardingScheme::RANGE : ShardingScheme::HASH;
+        } else if (arg == "--range-size"s) {
+            range_size = stoi(value);
+        } else if (arg == "--documents"s) {
+            document_count = stoi(value);
+        } else if (arg == "--queries"s) {
+            query_count = stoi(value);
+        } else if (arg == "--dictionary-size"s) {
+            dictionary_size = stoi(value);
+        } else if (arg == "--stop-words"s) {
+            stop_words = value;
+        } else if (arg == "--seed"s) {
+            seed = stoul(value);
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (spawn_count <= 0 && endpoints.empty()) {
+        PrintUsage();
+        return 1;
+    }
+ 
+    vector<pid_t> children;
+    for (int i = 0; i < spawn_count; ++i) {
+        const string path = "/tmp/search_shard_"s + to_string(getpid()) + "_"s + to_string(i) + ".sock"s;
+        const pid_t pid = fork();
+        if (pid == 0) {
+            RunShard(path, stop_words);
+        }
+        if (pid < 0) {
+            cerr << "fork failed"s << endl;
+            return 1;
+        }
+        children.push_back(pid);
+        endpoints.push_back("unix:"s + path);
+    }
+    if (scheme == ShardingScheme::RANGE && range_size <= 0) {
+        range_size = (document_count + endpoints.size() - 1) / endpoints.size();
+    }
+ 
+    int mismatches = 0;
+    try {
+        ShardCoordinator coordinator = ConnectWithRetry(endpoints, scheme, range_size);
+        SearchServer reference(stop_words);
+ 
+        mt19937 generator(seed);
+        const auto dictionary = GenerateDictionary(generator, dictionary_size, 10);
+        const auto documents = GenerateQueries(generator, dictionary, document_count, 70);
+        for (int id = 0; id < document_count; ++id) {
+            const vector<int> ratings = {id % 7, id % 11};
+            coordinator.AddDocument(id, documents[id], DocumentStatus::ACTUAL, ratings);
+            reference.AddDocument(id, documents[id], DocumentStatus::ACTUAL, ratings);
+        }
+ 
+        vector<string> queries;
+        for (int i = 0; i < query_count; ++i) {
+            queries.push_back(GenerateQuery(generator, dictionary, 10, 0.1));
+        }
+ 
+        mismatches += CompareRankings(reference, coordinator, queries);
+        for (int id = 0; id < document_count; id += 7) {
+            coordinator.RemoveDocument(id);
+            reference.RemoveDocument(id);
+        }
+        mismatches += CompareRankings(reference, coordinator, queries);
+ 
+        for (int id = 1; id < document_count; id += document_count / 50 + 1) {
+            if (id % 7 == 0) {
+                continue;
+            }
+            const auto [expected_words, expected_status] = reference.MatchDocument(queries[id % queries.size()], id);
+            const auto [actual_words, actual_status] = coordinator.MatchDocument(queries[id % queries.size()], id);
+            if (vector<string>(expected_words.begin(), expected_words.end()) != actual_words
+                || expected_status != actual_status) {
+                ++mismatches;
+                cerr << "MatchDocument mismatch for document "s << id << endl;
+            }
+        }
+ 
+        cout << endpoints.size() << " shards, "s << reference.GetDocumentCount() << " documents, "s
+             << 2 * queries.size() << " queries, mismatches: "s << mismatches << endl;
+    } catch (const exception& e) {
+        cerr << "shard_coordinator: "s << e.what() << endl;
+        mismatches = -1;
+    }
+ 
+    for (const pid_t pid : children) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
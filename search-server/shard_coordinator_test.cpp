@@ -0,0 +1,130 @@
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "query_generator.h"
+#include "search_daemon.h"
+#include "search_server.h"
+#include "shard_coordinator.h"
+#include "test_framework.h"
+
+using namespace std;
+
+namespace {
+
+const string STOP_WORDS = "и в на"s;
+
+// Шарды работают в потоках этого процесса, каждый на своём Unix-сокете.
+class LocalShards {
+public:
+    explicit LocalShards(int shard_count) {
+        for (int i = 0; i < shard_count; ++i) {
+            auto shard = make_unique<Shard>();
+            const string path = "/tmp/shard_coordinator_test_"s + to_string(getpid()) + "_"s + to_string(i) + ".sock"s;
+            shard->daemon.ListenUnix(path);
+            shard->runner = thread([daemon = &shard->daemon] { daemon->Run(); });
+            endpoints_.push_back("unix:"s + path);
+            shards_.push_back(move(shard));
+        }
+    }
+
+    ~LocalShards() {
+        for (auto& shard : shards_) {
+            shard->daemon.Stop();
+            shard->runner.join();
+        }
+    }
+
+    const vector<string>& GetEndpoints() const {
+        return endpoints_;
+    }
+
+private:
+    struct Shard {
+        SearchServer search_server{STOP_WORDS};
+        SearchDaemon daemon{search_server, 2};
+        thread runner;
+    };
+
+    vector<unique_ptr<Shard>> shards_;
+    vector<string> endpoints_;
+};
+
+void AssertSameRanking(const vector<Document>& actual, const vector<Document>& expected, const string& query) {
+    ASSERT_EQUAL_HINT(actual.size(), expected.size(), query);
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_EQUAL_HINT(actual[i].id, expected[i].id, query);
+        ASSERT_EQUAL_HINT(actual[i].rating, expected[i].rating, query);
+        ASSERT_HINT(abs(actual[i].relevance - expected[i].relevance) < SearchServer::EPSILON, query);
+    }
+}
+
+void AssertShardsMatchSingleServer(ShardingScheme scheme, int range_size) {
+    const LocalShards shards(3);
+    ShardCoordinator coordinator(shards.GetEndpoints(), scheme, range_size);
+    SearchServer reference(STOP_WORDS);
+
+    mt19937 generator(17);
+    const auto dictionary = GenerateDictionary(generator, 60, 6);
+    const auto documents = GenerateQueries(generator, dictionary, 600, 20);
+    for (int id = 0; id < 600; ++id) {
+        const vector<int> ratings = {id % 7, id % 3};
+        const DocumentStatus status = id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        coordinator.AddDocument(id, documents[id], status, ratings);
+        reference.AddDocument(id, documents[id], status, ratings);
+    }
+    // одинаковые документы на разных шардах: порядок решает только id
+    for (int id = 600; id < 620; ++id) {
+        coordinator.AddDocument(id, "одинаковый текст"s, DocumentStatus::ACTUAL, {1});
+        reference.AddDocument(id, "одинаковый текст"s, DocumentStatus::ACTUAL, {1});
+    }
+
+    vector<string> queries = {"одинаковый"s, "текст -одинаковый"s, "несуществующее"s};
+    for (int i = 0; i < 100; ++i) {
+        queries.push_back(GenerateQuery(generator, dictionary, 3, 0.2));
+    }
+    const auto compare = [&] {
+        for (const string& query : queries) {
+            AssertSameRanking(coordinator.FindTopDocuments(query), reference.FindTopDocuments(query), query);
+            AssertSameRanking(coordinator.FindTopDocuments(query, DocumentStatus::BANNED),
+                              reference.FindTopDocuments(query, DocumentStatus::BANNED), query);
+        }
+    };
+    compare();
+
+    for (int id = 0; id < 620; id += 3) {
+        coordinator.RemoveDocument(id);
+        reference.RemoveDocument(id);
+    }
+    compare();
+}
+
+}  // namespace
+
+void TestHashShardsMatchSingleServer() {
+    AssertShardsMatchSingleServer(ShardingScheme::HASH, 0);
+}
+
+void TestRangeShardsMatchSingleServer() {
+    AssertShardsMatchSingleServer(ShardingScheme::RANGE, 200);
+}
+
+void TestRankingTieBreak() {
+    const Document first = {1, 0.5, 3};
+    const Document close = {2, 0.5 + SearchServer::EPSILON / 2, 3};
+    ASSERT(SearchServer::IsMoreRelevant(first, close));
+    ASSERT(!SearchServer::IsMoreRelevant(close, first));
+    ASSERT(SearchServer::IsMoreRelevant({5, 0.5, 4}, first));
+    ASSERT(SearchServer::IsMoreRelevant({5, 0.5 + 2 * SearchServer::EPSILON, 0}, first));
+    ASSERT(!SearchServer::IsMoreRelevant(first, first));
+}
+
+int main() {
+    RUN_TEST(TestRankingTieBreak);
+    RUN_TEST(TestHashShardsMatchSingleServer);
+    RUN_TEST(TestRangeShardsMatchSingleServer);
+}
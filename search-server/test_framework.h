@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Минимальный фреймворк для *_test.cpp: проверки не зависят от NDEBUG,
+// первая неудачная завершает процесс, и ctest помечает тест как упавший.
+
+template <typename T, typename U>
+void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str,
+                     const std::string& file, const std::string& func, unsigned line,
+                     const std::string& hint) {
+    if (t != u) {
+        std::cerr << std::boolalpha;
+        std::cerr << file << "(" << line << "): " << func << ": ";
+        std::cerr << "ASSERT_EQUAL(" << t_str << ", " << u_str << ") failed: ";
+        std::cerr << t << " != " << u << ".";
+        if (!hint.empty()) {
+            std::cerr << " Hint: " << hint;
+        }
+        std::cerr << std::endl;
+        std::abort();
+    }
+}
+
+#define ASSERT_EQUAL(a, b) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, std::string())
+
+#define ASSERT_EQUAL_HINT(a, b, hint) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+inline void AssertImpl(bool value, const std::string& expr_str, const std::string& file,
+                       const std::string& func, unsigned line, const std::string& hint) {
+    if (!value) {
+        std::cerr << file << "(" << line << "): " << func << ": ";
+        std::cerr << "ASSERT(" << expr_str << ") failed.";
+        if (!hint.empty()) {
+            std::cerr << " Hint: " << hint;
+        }
+        std::cerr << std::endl;
+        std::abort();
+    }
+}
+
+#define ASSERT(expr) AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, std::string())
+
+#define ASSERT_HINT(expr, hint) AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+// Проверяет, что выражение бросает исключение указанного типа.
+#define ASSERT_THROWS(expr, exception)                                                   \
+    do {                                                                                 \
+        bool thrown = false;                                                             \
+        try {                                                                            \
+            expr;                                                                        \
+        } catch (const exception&) {                                                     \
+            thrown = true;                                                               \
+        }                                                                                \
+        AssertImpl(thrown, #expr " throws " #exception, __FILE__, __FUNCTION__, __LINE__, \
+                   std::string());                                                       \
+    } while (false)
+
+template <typename Func>
+void RunTestImpl(Func func, const std::string& func_name) {
+    func();
+    std::cerr << func_name << " OK" << std::endl;
+}
+
+#define RUN_TEST(func) RunTestImpl((func), #func)
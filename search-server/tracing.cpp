@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+#include "tracing.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+const char* GetStageName(size_t stage) {
+    static const char* const names[TRACE_STAGE_COUNT] = {
+        "FindTopDocuments",
+        "ParseQuery",
+        "FindAllDocuments",
+        "SortResults",
+        "MatchDocument",
+    };
+    return names[stage];
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<tracing_detail::ThreadHistograms*> threads;
+    // гистограммы завершившихся потоков, меняются только под mutex
+    tracing_detail::ThreadHistograms retired;
+    std::atomic<uint64_t> generation = 0;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+void Clear(tracing_detail::ThreadHistograms& histograms) {
+    for (auto& parent_stages : histograms.stages) {
+        for (tracing_detail::Histogram& histogram : parent_stages) {
+            for (auto& bucket : histogram.buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            histogram.count.store(0, std::memory_order_relaxed);
+            histogram.max_ns.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Merge(tracing_detail::ThreadHistograms& to, const tracing_detail::ThreadHistograms& from) {
+    for (size_t parent = 0; parent < tracing_detail::PARENT_COUNT; ++parent) {
+        for (size_t stage = 0; stage < TRACE_STAGE_COUNT; ++stage) {
+            tracing_detail::Histogram& target = to.stages[parent][stage];
+            const tracing_detail::Histogram& source = from.stages[parent][stage];
+            for (size_t i = 0; i < tracing_detail::BUCKET_COUNT; ++i) {
+                target.buckets[i].fetch_add(source.buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            target.count.fetch_add(source.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            const uint64_t max_ns = source.max_ns.load(std::memory_order_relaxed);
+            if (max_ns > target.max_ns.load(std::memory_order_relaxed)) {
+                target.max_ns.store(max_ns, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+// Владеет гистограммами потока: регистрирует их при первом замере,
+// а при завершении потока сливает в Registry::retired и освобождает.
+class ThreadHistogramsOwner {
+public:
+    ThreadHistogramsOwner()
+        : histograms_(std::make_unique<tracing_detail::ThreadHistograms>()) {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        histograms_->generation.store(registry.generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        registry.threads.push_back(histograms_.get());
+    }
+
+    ~ThreadHistogramsOwner() {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        if (histograms_->generation.load(std::memory_order_relaxed) == registry.generation.load(std::memory_order_relaxed)) {
+            Merge(registry.retired, *histograms_);
+        }
+        registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), histograms_.get()));
+    }
+
+    ThreadHistogramsOwner(const ThreadHistogramsOwner&) = delete;
+    ThreadHistogramsOwner& operator=(const ThreadHistogramsOwner&) = delete;
+
+    tracing_detail::ThreadHistograms& Get() {
+        return *histograms_;
+    }
+
+private:
+    std::unique_ptr<tracing_detail::ThreadHistograms> histograms_;
+};
+
+uint64_t GetPercentile(const std::array<uint64_t, tracing_detail::BUCKET_COUNT>& buckets,
+                       uint64_t count, double percentile) {
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(percentile * count + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return tracing_detail::GetBucketValue(i);
+        }
+    }
+    return tracing_detail::GetBucketValue(buckets.size() - 1);
+}
+
+}  // namespace
+
+namespace tracing_detail {
+
+size_t GetBucketIndex(uint64_t value_ns) {
+    if (value_ns < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value_ns);
+    }
+    const size_t exponent = std::min<size_t>(63 - __builtin_clzll(value_ns), MAX_EXPONENT);
+    if (exponent == MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+    const size_t sub_bucket = (value_ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub_bucket;
+}
+
+uint64_t GetBucketValue(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    const size_t exponent = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+    const uint64_t sub_bucket = index % SUB_BUCKET_COUNT;
+    const uint64_t lower = (SUB_BUCKET_COUNT + sub_bucket) << (exponent - SUB_BUCKET_BITS);
+    const uint64_t width = uint64_t{1} << (exponent - SUB_BUCKET_BITS);
+    return lower + width / 2;
+}
+
+ThreadHistograms& GetThreadHistograms() {
+    thread_local ThreadHistogramsOwner owner;
+    ThreadHistograms& histograms = owner.Get();
+    const uint64_t generation = GetRegistry().generation.load(std::memory_order_relaxed);
+    if (histograms.generation.load(std::memory_order_relaxed) != generation) {
+        // после ResetTraces: в гистограммы пишет только этот поток, гонки с Record нет
+        Clear(histograms);
+        histograms.generation.store(generation, std::memory_order_release);
+    }
+    return histograms;
+}
+
+}  // namespace tracing_detail
+
+std::vector<StageLatency> CollectTraceSnapshot() {
+    using namespace tracing_detail;
+
+    // мьютекс удерживается до конца суммирования: завершающийся поток
+    // не может освободить свои гистограммы или слить их дважды
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    const uint64_t generation = registry.generation.load(std::memory_order_relaxed);
+    std::vector<const ThreadHistograms*> sources = {&registry.retired};
+    for (const ThreadHistograms* thread : registry.threads) {
+        // гистограммы, ещё не обнулённые после ResetTraces, не учитываются
+        if (thread->generation.load(std::memory_order_acquire) == generation) {
+            sources.push_back(thread);
+        }
+    }
+
+    std::vector<StageLatency> snapshot;
+    for (size_t parent = 0; parent < PARENT_COUNT; ++parent) {
+        for (size_t stage = 0; stage < TRACE_STAGE_COUNT; ++stage) {
+            std::array<uint64_t, BUCKET_COUNT> buckets{};
+            StageLatency latency;
+            for (const ThreadHistograms* source : sources) {
+                const Histogram& histogram = source->stages[parent][stage];
+                for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+                    buckets[i] += histogram.buckets[i].load(std::memory_order_relaxed);
+                }
+                latency.count += histogram.count.load(std::memory_order_relaxed);
+                latency.max_ns = std::max(latency.max_ns, histogram.max_ns.load(std::memory_order_relaxed));
+            }
+            if (latency.count == 0) {
+                continue;
+            }
+            latency.path = parent == TRACE_STAGE_COUNT
+                ? std::string(GetStageName(stage))
+                : GetStageName(parent) + "/"s + GetStageName(stage);
+            latency.p50_ns = std::min(GetPercentile(buckets, latency.count, 0.5), latency.max_ns);
+            latency.p99_ns = std::min(GetPercentile(buckets, latency.count, 0.99), latency.max_ns);
+            latency.p999_ns = std::min(GetPercentile(buckets, latency.count, 0.999), latency.max_ns);
+            snapshot.push_back(std::move(latency));
+        }
+    }
+    std::sort(snapshot.begin(), snapshot.end(), [](const StageLatency& lhs, const StageLatency& rhs) {
+        return lhs.path < rhs.path;
+    });
+    return snapshot;
+}
+
+void ResetTraces() {
+    // Чужие гистограммы не трогаем: их владельцы пишут без атомарного
+    // инкремента, и обнуление отсюда могло бы потеряться.
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    registry.generation.fetch_add(1, std::memory_order_relaxed);
+    Clear(registry.retired);
+}
+
+std::ostream& operator<<(std::ostream& out, const StageLatency& latency) {
+    out << latency.path << ": count = "s << latency.count
+        << ", p50 = "s << latency.p50_ns << " ns"s
+        << ", p99 = "s << latency.p99_ns << " ns"s
+        << ", p999 = "s << latency.p999_ns << " ns"s
+        << ", max = "s << latency.max_ns << " ns"s;
+    return out;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "log_duration.h"
+
+// Трассировка этапов поиска с наносекундным разрешением.
+// Включается макросом SEARCH_SERVER_TRACING; без него TRACE_SCOPE раскрывается
+// в пустое выражение и не стоит ничего.
+// Каждый поток пишет в свои гистограммы без блокировок, CollectTraceSnapshot
+// сливает их и считает перцентили отдельно для каждой пары (родитель, этап).
+// Гистограммы завершившегося потока переносятся в общий накопитель и освобождаются.
+
+enum class TraceStage {
+    FIND_TOP_DOCUMENTS,
+    PARSE_QUERY,
+    FIND_ALL_DOCUMENTS,
+    SORT_RESULTS,
+    MATCH_DOCUMENT,
+};
+
+constexpr size_t TRACE_STAGE_COUNT = 5;
+
+struct StageLatency {
+    std::string path;
+    uint64_t count = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+std::vector<StageLatency> CollectTraceSnapshot();
+void ResetTraces();
+
+std::ostream& operator<<(std::ostream& out, const StageLatency& latency);
+
+namespace tracing_detail {
+
+// Лог-линейные корзины: 8 корзин на каждую степень двойки, погрешность до 12.5%.
+constexpr size_t SUB_BUCKET_BITS = 3;
+constexpr size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+constexpr size_t MAX_EXPONENT = 40;
+constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+constexpr size_t PARENT_COUNT = TRACE_STAGE_COUNT + 1;  // последний — нет родителя
+
+size_t GetBucketIndex(uint64_t value_ns);
+uint64_t GetBucketValue(size_t index);
+
+struct Histogram {
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<uint64_t> count = 0;
+    std::atomic<uint64_t> max_ns = 0;
+
+    // Пишет только поток-владелец, поэтому достаточно load/store.
+    void Record(uint64_t value_ns) {
+        auto& bucket = buckets[GetBucketIndex(value_ns)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (value_ns > max_ns.load(std::memory_order_relaxed)) {
+            max_ns.store(value_ns, std::memory_order_relaxed);
+        }
+    }
+};
+
+struct ThreadHistograms {
+    std::array<std::array<Histogram, TRACE_STAGE_COUNT>, PARENT_COUNT> stages;
+    size_t current_parent = TRACE_STAGE_COUNT;
+    // Поколение ResetTraces, к которому относятся данные. После сброса поток
+    // обнуляет свои гистограммы сам, а до этого CollectTraceSnapshot их пропускает.
+    std::atomic<uint64_t> generation = 0;
+};
+
+ThreadHistograms& GetThreadHistograms();
+
+}  // namespace tracing_detail
+
+class TraceScope {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TraceScope(TraceStage stage)
+        : histograms_(tracing_detail::GetThreadHistograms())
+        , stage_(static_cast<size_t>(stage))
+        , parent_(histograms_.current_parent) {
+        histograms_.current_parent = stage_;
+    }
+
+    ~TraceScope() {
+        const auto duration = Clock::now() - start_time_;
+        histograms_.current_parent = parent_;
+        histograms_.stages[parent_][stage_].Record(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    tracing_detail::ThreadHistograms& histograms_;
+    const size_t stage_;
+    const size_t parent_;
+    const Clock::time_point start_time_ = Clock::now();
+};
+
+#ifdef SEARCH_SERVER_TRACING
+#define TRACE_SCOPE(stage) TraceScope UNIQUE_VAR_NAME_PROFILE(stage)
+#else
+#define TRACE_SCOPE(stage) static_cast<void>(0)
+#endif
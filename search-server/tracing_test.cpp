@@ -0,0 +1,78 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_framework.h"
+#include "tracing.h"
+
+using namespace std;
+
+namespace {
+
+void RecordStage(TraceStage stage, int count) {
+    for (int i = 0; i < count; ++i) {
+        TraceScope scope(stage);
+    }
+}
+
+uint64_t GetCount(const string& path) {
+    for (const StageLatency& latency : CollectTraceSnapshot()) {
+        if (latency.path == path) {
+            return latency.count;
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+void TestFinishedThreadsAreKept() {
+    ResetTraces();
+    for (int round = 0; round < 20; ++round) {
+        vector<thread> threads;
+        for (int i = 0; i < 10; ++i) {
+            threads.emplace_back(RecordStage, TraceStage::MATCH_DOCUMENT, 5);
+        }
+        for (thread& worker : threads) {
+            worker.join();
+        }
+    }
+    ASSERT_EQUAL(GetCount("MatchDocument"s), 20u * 10u * 5u);
+}
+
+void TestResetTraces() {
+    RecordStage(TraceStage::PARSE_QUERY, 7);
+    ASSERT(GetCount("ParseQuery"s) >= 7u);
+    ResetTraces();
+    ASSERT(CollectTraceSnapshot().empty());
+    RecordStage(TraceStage::PARSE_QUERY, 3);
+    ASSERT_EQUAL(GetCount("ParseQuery"s), 3u);
+}
+
+void TestResetWhileRecording() {
+    atomic<bool> stop = false;
+    thread writer([&stop] {
+        while (!stop) {
+            RecordStage(TraceStage::SORT_RESULTS, 100);
+        }
+        RecordStage(TraceStage::FIND_ALL_DOCUMENTS, 1);
+    });
+    for (int i = 0; i < 1000; ++i) {
+        ResetTraces();
+    }
+    stop = true;
+    writer.join();
+
+    // сброс, сделанный пока поток писал, не должен затираться его данными
+    ResetTraces();
+    RecordStage(TraceStage::SORT_RESULTS, 2);
+    ASSERT_EQUAL(GetCount("SortResults"s), 2u);
+    ASSERT_EQUAL(GetCount("FindAllDocuments"s), 0u);
+}
+
+int main() {
+    RUN_TEST(TestFinishedThreadsAreKept);
+    RUN_TEST(TestResetTraces);
+    RUN_TEST(TestResetWhileRecording);
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "word_filters.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+uint64_t HashWord(std::string_view word, uint64_t seed) {
+    // FNV-1a с зависящим от зерна начальным значением и финальным перемешиванием
+    uint64_t hash = 0xcbf29ce484222325ULL ^ (seed * 0x9e3779b97f4a7c15ULL);
+    for (const char c : word) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+constexpr uint32_t MAX_BUCKET_SEED = 1u << 24;
+
+}  // namespace
+
+StopWordTable::StopWordTable(const std::set<std::string, std::less<>>& words,
+                             const allocator_type& allocator)
+    : words_(words.begin(), words.end(), allocator)
+    , bucket_seeds_(allocator)
+    , slots_(allocator) {
+    if (words_.empty()) {
+        return;
+    }
+    size_t slot_count = 1;
+    while (slot_count < 2 * words_.size()) {
+        slot_count *= 2;
+    }
+    slot_mask_ = slot_count - 1;
+    slots_.assign(slot_count, -1);
+
+    const size_t bucket_count = std::max<size_t>(1, words_.size() / 4);
+    std::vector<std::vector<int32_t>> buckets(bucket_count);
+    for (size_t i = 0; i < words_.size(); ++i) {
+        buckets[HashWord(words_[i], 0) % bucket_count].push_back(static_cast<int32_t>(i));
+    }
+    std::vector<size_t> order(bucket_count);
+    for (size_t i = 0; i < bucket_count; ++i) {
+        order[i] = i;
+    }
+    // большие корзины размещаются первыми, пока таблица свободна
+    std::sort(order.begin(), order.end(), [&buckets](size_t lhs, size_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    bucket_seeds_.assign(bucket_count, 0);
+    std::vector<size_t> bucket_slots;
+    for (const size_t bucket : order) {
+        if (buckets[bucket].empty()) {
+            continue;
+        }
+        uint32_t seed = 1;
+        for (; seed < MAX_BUCKET_SEED; ++seed) {
+            bucket_slots.clear();
+            bool is_placed = true;
+            for (const int32_t word_index : buckets[bucket]) {
+                const size_t slot = HashWord(words_[word_index], seed) & slot_mask_;
+                if (slots_[slot] != -1
+                    || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end()) {
+                    is_placed = false;
+                    break;
+                }
+                bucket_slots.push_back(slot);
+            }
+            if (is_placed) {
+                break;
+            }
+        }
+        if (seed == MAX_BUCKET_SEED) {
+            throw std::logic_error("Cannot build perfect hash for stop words"s);
+        }
+        bucket_seeds_[bucket] = seed;
+        for (size_t i = 0; i < bucket_slots.size(); ++i) {
+            slots_[bucket_slots[i]] = buckets[bucket][i];
+        }
+    }
+}
+
+bool StopWordTable::Contains(std::string_view word) const {
+    if (words_.empty()) {
+        return false;
+    }
+    const uint32_t seed = bucket_seeds_[HashWord(word, 0) % bucket_seeds_.size()];
+    const int32_t word_index = slots_[HashWord(word, seed) & slot_mask_];
+    return word_index >= 0 && words_[word_index] == word;
+}
+
+size_t StopWordTable::size() const {
+    return words_.size();
+}
+
+StopWordTable::const_iterator StopWordTable::begin() const {
+    return words_.begin();
+}
+
+StopWordTable::const_iterator StopWordTable::end() const {
+    return words_.end();
+}
+
+size_t StopWordTable::GetTableBytes() const {
+    return bucket_seeds_.capacity() * sizeof(uint32_t) + slots_.capacity() * sizeof(int32_t);
+}
+
+TermFilter::TermFilter(size_t capacity, const allocator_type& allocator)
+    : blocks_(allocator)
+    , block_count_(std::max<size_t>(1, (capacity * BITS_PER_TERM + 511) / 512))
+    , capacity_(capacity) {
+    blocks_.assign(block_count_ * WORDS_PER_BLOCK, 0);
+}
+
+void TermFilter::Add(std::string_view word) {
+    const uint64_t hash = HashWord(word, 0);
+    uint64_t* block = &blocks_[((hash >> 32) * block_count_ >> 32) * WORDS_PER_BLOCK];
+    const uint32_t h1 = static_cast<uint32_t>(hash);
+    const uint32_t h2 = static_cast<uint32_t>((hash * 0x9e3779b97f4a7c15ULL) >> 40) | 1;
+    for (int i = 0; i < HASH_COUNT; ++i) {
+        const uint32_t bit = (h1 + i * h2) & 511;
+        block[bit >> 6] |= uint64_t{1} << (bit & 63);
+    }
+}
+
+bool TermFilter::MayContain(std::string_view word) const {
+    const uint64_t hash = HashWord(word, 0);
+    const uint64_t* block = &blocks_[((hash >> 32) * block_count_ >> 32) * WORDS_PER_BLOCK];
+    const uint32_t h1 = static_cast<uint32_t>(hash);
+    const uint32_t h2 = static_cast<uint32_t>((hash * 0x9e3779b97f4a7c15ULL) >> 40) | 1;
+    for (int i = 0; i < HASH_COUNT; ++i) {
+        const uint32_t bit = (h1 + i * h2) & 511;
+        if ((block[bit >> 6] & (uint64_t{1} << (bit & 63))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t TermFilter::GetCapacity() const {
+    return capacity_;
+}
+
+size_t TermFilter::GetBytes() const {
+    return blocks_.capacity() * sizeof(uint64_t);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "memory_stats.h"
+
+// Неизменяемое множество стоп-слов на совершенном хешировании (hash and displace):
+// слово попадает в корзину, у каждой корзины подобрано своё зерно, при котором
+// её слова ложатся в свободные ячейки таблицы. Поиск — два хеша и одно сравнение строк.
+class StopWordTable {
+public:
+    using const_iterator = CountedVector<std::string, MemoryCategory::STOP_WORDS>::const_iterator;
+    using allocator_type = CountingAllocator<std::string, MemoryCategory::STOP_WORDS>;
+
+    StopWordTable() = default;
+    explicit StopWordTable(const std::set<std::string, std::less<>>& words,
+                           const allocator_type& allocator = allocator_type());
+
+    bool Contains(std::string_view word) const;
+
+    size_t size() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    size_t GetTableBytes() const;
+
+private:
+    CountedVector<std::string, MemoryCategory::STOP_WORDS> words_;
+    CountedVector<uint32_t, MemoryCategory::STOP_WORDS> bucket_seeds_;
+    CountedVector<int32_t, MemoryCategory::STOP_WORDS> slots_;
+    uint64_t slot_mask_ = 0;
+};
+
+// Блочный фильтр Блума над словарём: все биты слова лежат в одной 64-байтной
+// кэш-линии. Ложноположительных ответов около процента при заданной ёмкости,
+// ложноотрицательных нет. Удаление не поддерживается — фильтр перестраивают.
+class TermFilter {
+public:
+    using allocator_type = CountingAllocator<uint64_t, MemoryCategory::DICTIONARY>;
+
+    explicit TermFilter(size_t capacity = 0, const allocator_type& allocator = allocator_type());
+
+    void Add(std::string_view word);
+    bool MayContain(std::string_view word) const;
+
+    size_t GetCapacity() const;
+    size_t GetBytes() const;
+
+private:
+    static constexpr size_t WORDS_PER_BLOCK = 8;
+    static constexpr size_t BITS_PER_TERM = 10;
+    static constexpr int HASH_COUNT = 6;
+
+    CountedVector<uint64_t, MemoryCategory::DICTIONARY> blocks_;
+    size_t block_count_ = 0;
+    size_t capacity_ = 0;
+};
@@ -0,0 +1,109 @@
+#include <set>
+#include <string>
+#include <vector>
+
+#include "search_server.h"
+#include "test_framework.h"
+#include "word_filters.h"
+
+using namespace std;
+
+namespace {
+
+set<string, less<>> MakeWords(const string& prefix, int count) {
+    set<string, less<>> words;
+    for (int i = 0; i < count; ++i) {
+        words.insert(prefix + to_string(i));
+    }
+    return words;
+}
+
+}  // namespace
+
+void TestEmptyStopWordTable() {
+    const StopWordTable default_table;
+    ASSERT_EQUAL(default_table.size(), 0u);
+    ASSERT(!default_table.Contains("в"s));
+    ASSERT(!default_table.Contains(""s));
+
+    const StopWordTable empty_table(set<string, less<>>{});
+    ASSERT_EQUAL(empty_table.size(), 0u);
+    ASSERT(empty_table.begin() == empty_table.end());
+    ASSERT(!empty_table.Contains("в"s));
+}
+
+void TestStopWordTableLookup() {
+    const set<string, less<>> single = {"и"s};
+    const StopWordTable single_table(single);
+    ASSERT(single_table.Contains("и"s));
+    ASSERT(!single_table.Contains("и "s));
+    ASSERT(!single_table.Contains("в"s));
+    ASSERT(!single_table.Contains(""s));
+
+    // общие префиксы и слова, отличающиеся одним байтом
+    const set<string, less<>> similar = {"a"s, "aa"s, "aaa"s, "ab"s, "ba"s, "на"s, "над"s, "нас"s};
+    const StopWordTable similar_table(similar);
+    for (const string& word : similar) {
+        ASSERT_HINT(similar_table.Contains(word), word);
+    }
+    for (const string& word : {"b"s, "aab"s, "bb"s, "н"s, "надо"s, "наш"s}) {
+        ASSERT_HINT(!similar_table.Contains(word), word);
+    }
+
+    for (const int count : {2, 5, 64, 1000, 5000}) {
+        const auto words = MakeWords("стоп"s, count);
+        const StopWordTable table(words);
+        ASSERT_EQUAL(table.size(), words.size());
+        ASSERT(vector<string>(table.begin(), table.end()) == vector<string>(words.begin(), words.end()));
+        for (const string& word : words) {
+            ASSERT_HINT(table.Contains(word), word);
+        }
+        for (const string& word : MakeWords("слово"s, count)) {
+            ASSERT_HINT(!table.Contains(word), word);
+        }
+        ASSERT(!table.Contains(to_string(count)));
+    }
+}
+
+void TestTermFilter() {
+    constexpr int COUNT = 20000;
+    TermFilter filter(COUNT);
+    ASSERT_EQUAL(filter.GetCapacity(), static_cast<size_t>(COUNT));
+    ASSERT(filter.GetBytes() > 0u);
+
+    const auto words = MakeWords("слово"s, COUNT);
+    for (const string& word : words) {
+        filter.Add(word);
+    }
+    for (const string& word : words) {
+        ASSERT_HINT(filter.MayContain(word), word);
+    }
+
+    int false_positives = 0;
+    for (const string& word : MakeWords("чужое"s, COUNT)) {
+        false_positives += filter.MayContain(word) ? 1 : 0;
+    }
+    // при 10 битах на слово ожидается около процента
+    ASSERT_HINT(false_positives < COUNT * 3 / 100, to_string(false_positives));
+}
+
+void TestStopWordsInSearchServer() {
+    SearchServer search_server("и в на"s);
+    search_server.AddDocument(1, "кот в шляпе"s, DocumentStatus::ACTUAL, {1});
+    search_server.AddDocument(2, "пёс на сене"s, DocumentStatus::ACTUAL, {2});
+
+    ASSERT(search_server.FindTopDocuments("в на и"s).empty());
+    ASSERT_EQUAL(search_server.FindTopDocuments("кот -в"s).size(), 1u);
+    const auto [words, status] = search_server.MatchDocument("кот в шляпе"s, 1);
+    ASSERT_EQUAL(words.size(), 2u);
+    ASSERT_EQUAL(search_server.GetWordFrequencies(1).count("в"s), 0u);
+
+    ASSERT_THROWS(SearchServer(vector<string>{"и"s, "в\x01"s}), invalid_argument);
+}
+
+int main() {
+    RUN_TEST(TestEmptyStopWordTable);
+    RUN_TEST(TestStopWordTableLookup);
+    RUN_TEST(TestTermFilter);
+    RUN_TEST(TestStopWordsInSearchServer);
+}